@@ -0,0 +1,334 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "egdbcache.h"
+#include "fen.h"
+#include "opponent.h"
+#include "protocol.h"
+
+using namespace checkers;
+using namespace checkers::opponent;
+
+/*
+ * A batch analyzer, which searches every position of a stream
+ * and writes one JSON line for each: its index in the input,
+ * its FEN, the best move with every jump, the score, the depth
+ * reached, the nodes searched and the time taken in
+ * milliseconds, or an error if it could not be read.
+ *
+ * usage: analyze <input> [depth] [threads] [--binary] [--tagged]
+ *                [--shared] [--nodes n] [--movetime ms] [--hash mb]
+ *                [--weights file] [--egdb dir]
+ *
+ * The input, or the standard input if it is "-", holds a FEN
+ * at the start of each line, or with --binary a run of
+ * PackedPosition records. The positions are read into a
+ * bounded queue and searched by a pool of threads, each with
+ * its own search and, unless --shared is given, its own
+ * transposition table of the given size. The results are
+ * written in input order, held back only within a bounded
+ * window, or with --tagged as soon as each is found. Either
+ * way the memory used does not grow with the input.
+ */
+namespace {
+
+    /** The depth of each search by default. */
+    constexpr int DefaultDepth = 12;
+
+    /** The size of each transposition table by default. */
+    constexpr size_t DefaultTableMegabytes = 16;
+
+    /** The most positions queued for each thread. */
+    constexpr size_t QueuedPerThread = 4;
+
+    /**
+     * The most results held back for each thread while an
+     * earlier position is still being searched.
+     */
+    constexpr size_t WindowPerThread = 64;
+
+    /**
+     * <summary>
+     * A position read, in either form, and its index.
+     * </summary>
+     *
+     * @struct Job
+     */
+    struct Job final {
+        uint64_t index;
+        std::string fen;
+        PackedPosition packed;
+    };
+
+    /**
+     * <summary>
+     * The queue of positions between the reader and the
+     * searches, and the reorder window between the searches
+     * and the output, under a single lock.
+     * </summary>
+     *
+     * @class Pipeline
+     */
+    class Pipeline final {
+    private:
+        std::mutex lock;
+        std::condition_variable jobReady, roomReady;
+        std::deque<Job> jobs;
+        size_t capacity;
+        bool finished;
+        bool tagged;
+        std::vector<std::string> window;
+        std::vector<bool> ready;
+        uint64_t nextOut;
+
+    public:
+        Pipeline(const size_t capacity, const size_t windowSize,
+                 const bool tagged) :
+                capacity(capacity),
+                finished(false),
+                tagged(tagged),
+                window(windowSize),
+                ready(windowSize),
+                nextOut(0) {}
+
+        /**
+         * A method to queue a position, waiting while the
+         * queue is full or, in order, while it is too far
+         * ahead of the output.
+         *
+         * @param j the position
+         */
+        void push(Job&& j) {
+            std::unique_lock<std::mutex> g(lock);
+            roomReady.wait(g, [&] {
+                return jobs.size() < capacity &&
+                       (tagged || j.index < nextOut + window.size());
+            });
+            jobs.push_back(std::move(j));
+            jobReady.notify_one();
+        }
+
+        /** A method to mark the end of the input. */
+        void finish() {
+            {
+                std::lock_guard<std::mutex> g(lock);
+                finished = true;
+            }
+            jobReady.notify_all();
+        }
+
+        /**
+         * A method to take the next position.
+         *
+         * @param j the position to fill
+         * @return whether or not there was one, false once the
+         * input has ended
+         */
+        bool pop(Job& j) {
+            std::unique_lock<std::mutex> g(lock);
+            jobReady.wait(g, [&] { return finished || !jobs.empty(); });
+            if(jobs.empty()) return false;
+            j = std::move(jobs.front());
+            jobs.pop_front();
+            roomReady.notify_one();
+            return true;
+        }
+
+        /**
+         * A method to hand in the result of a position,
+         * writing it and any it held back when their turn
+         * has come.
+         *
+         * @param index the index of the position
+         * @param line the result, without a newline
+         */
+        void complete(const uint64_t index, std::string&& line) {
+            std::lock_guard<std::mutex> g(lock);
+            if(tagged) {
+                std::cout << line << '\n';
+                return;
+            }
+            window[index % window.size()] = std::move(line);
+            ready[index % window.size()] = true;
+            for(size_t slot; ready[slot = nextOut % window.size()];
+                ++nextOut) {
+                std::cout << window[slot] << '\n';
+                window[slot].clear();
+                ready[slot] = false;
+            }
+            roomReady.notify_all();
+        }
+    };
+
+    /**
+     * A method to search one position and describe the
+     * result.
+     *
+     * @param search the search to use
+     * @param j the position
+     * @param limits the limits of the search
+     * @return the result as a line of JSON
+     */
+    std::string analyze(Search& search, const Job& j,
+                        const SearchLimits& limits) {
+        std::string out = "{\"index\":" + std::to_string(j.index);
+        State s;
+        Board::Builder builder(s);
+        if(j.fen.empty()? !unpackPosition(j.packed, builder):
+                          !parseFen(j.fen, builder))
+            return out + ",\"error\":\"unreadable position\"}";
+        const Board b = builder.build();
+        out += ",\"fen\":\"" + toFen(b) + '"';
+
+        const auto start = std::chrono::steady_clock::now();
+        search.setBoard(b);
+        const Move best = search.think(limits);
+        const PvLine line = search.line(0);
+        const uint64_t nodes = search.nodeCount();
+        std::string move = "null";
+        if(best != NullMove) {
+            Move steps[MaxMoveSteps];
+            const int n = completeMove(search, b, best, line, steps);
+            move = '"' + toMoveText(steps, n) + '"';
+        }
+        const auto time = std::chrono::duration_cast
+                <std::chrono::milliseconds>
+                (std::chrono::steady_clock::now() - start).count();
+        return out + ",\"move\":" + move +
+               ",\"score\":" + std::to_string(line.score) +
+               ",\"depth\":" + std::to_string(line.depth) +
+               ",\"nodes\":" + std::to_string(nodes) +
+               ",\"time\":" + std::to_string(time) + '}';
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <input> [depth] [threads]"
+                     " [--binary] [--tagged] [--shared] [--nodes n]"
+                     " [--movetime ms] [--hash mb] [--weights file]"
+                     " [--egdb dir]\n";
+        return 1;
+    }
+    SearchLimits limits;
+    limits.depth = DefaultDepth;
+    int threads = (int) std::max(1U, std::thread::hardware_concurrency());
+    bool binary = false, tagged = false, shared = false;
+    size_t tableMegabytes = DefaultTableMegabytes;
+    const char* weights = nullptr;
+    const char* egdbDir = nullptr;
+    for(int i = 2, positional = 0; i < argc; ++i) {
+        const bool valued = i + 1 < argc;
+        if(!std::strcmp(argv[i], "--binary")) binary = true;
+        else if(!std::strcmp(argv[i], "--tagged")) tagged = true;
+        else if(!std::strcmp(argv[i], "--shared")) shared = true;
+        else if(!std::strcmp(argv[i], "--nodes") && valued)
+            limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+        else if(!std::strcmp(argv[i], "--movetime") && valued)
+            limits.moveTime = std::atoll(argv[++i]);
+        else if(!std::strcmp(argv[i], "--hash") && valued)
+            tableMegabytes = std::max(1L, std::atol(argv[++i]));
+        else if(!std::strcmp(argv[i], "--weights") && valued)
+            weights = argv[++i];
+        else if(!std::strcmp(argv[i], "--egdb") && valued)
+            egdbDir = argv[++i];
+        else if(positional == 0 && std::atoi(argv[i]) > 0) {
+            limits.depth = std::atoi(argv[i]);
+            ++positional;
+        } else if(positional == 1 && std::atoi(argv[i]) > 0) {
+            threads = std::atoi(argv[i]);
+            ++positional;
+        } else {
+            std::cerr << "Unknown argument " << argv[i] << '\n';
+            return 1;
+        }
+    }
+
+    std::ifstream file;
+    if(std::strcmp(argv[1], "-") != 0) {
+        file.open(argv[1], std::ios::binary);
+        if(!file) {
+            std::cerr << "Cannot read " << argv[1] << '\n';
+            return 1;
+        }
+    }
+    std::ios::sync_with_stdio(false);
+    std::istream& in = file.is_open()? file: std::cin;
+
+    Network network;
+    Patterns patterns;
+    if(weights && !network.load(weights) && !patterns.load(weights)) {
+        std::cerr << "Cannot load weights " << weights << '\n';
+        return 1;
+    }
+    egdb::Database database;
+    egdb::BlockCache blockCache(16);
+    if(egdbDir) {
+        if(!database.open(egdbDir, 8)) {
+            std::cerr << "Cannot open endgame database " << egdbDir << '\n';
+            return 1;
+        }
+        database.setCache(&blockCache);
+    }
+
+    State rootState;
+    const Board root = Board::Builder(rootState).build();
+    std::vector<std::unique_ptr<TranspositionTable>> tables;
+    std::vector<std::unique_ptr<Search>> searches;
+    for(int t = 0; t < threads; ++t) {
+        if(!shared || tables.empty())
+            tables.push_back(std::make_unique<TranspositionTable>
+                             (tableMegabytes));
+        searches.push_back(std::make_unique<Search>(root, *tables.back()));
+        if(network.loaded()) searches[t]->setNetwork(&network);
+        else if(patterns.loaded()) searches[t]->setPatterns(&patterns);
+        if(egdbDir) searches[t]->setEndgameDatabase(&database);
+    }
+
+    Pipeline pipeline(QueuedPerThread * threads, WindowPerThread * threads,
+                      tagged);
+    std::vector<std::thread> pool;
+    for(int t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            for(Job j; pipeline.pop(j);) {
+                if(!shared) tables[t]->newSearch();
+                pipeline.complete(j.index,
+                                  analyze(*searches[t], j, limits));
+            }
+        });
+
+    // A shared table is aged by the reader, once for each
+    // round of as many positions as there are threads.
+    const auto queue = [&](Job&& j) {
+        if(shared && j.index % threads == 0) tables[0]->newSearch();
+        pipeline.push(std::move(j));
+    };
+    uint64_t index = 0;
+    if(binary) {
+        for(PackedPosition p; in.read((char*) &p, sizeof(p)); ++index)
+            queue({ index, {}, p });
+    } else {
+        // Anything after the FEN on a line, such as a result,
+        // is ignored.
+        for(std::string line; std::getline(in, line);) {
+            const size_t first = line.find_first_not_of(" \t\r");
+            if(first == std::string::npos) continue;
+            const size_t last = line.find_first_of(" \t\r", first);
+            queue({ index++, line.substr(first, last - first), {} });
+        }
+    }
+    pipeline.finish();
+    for(std::thread& th: pool) th.join();
+    std::cout.flush();
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <cstdint>
+#include <vector>
+#include "bitbase.h"
+
+#if defined(BITCHECKERS_BITBASE)
+// The bitbase is generated by egdbgen at build time and
+// assembled in as it is, so that it costs no I/O to load.
+asm(".section .rodata\n"
+    ".balign 64\n"
+    ".globl bitcheckersBitbase\n"
+    "bitcheckersBitbase:\n"
+    ".incbin \"" BITCHECKERS_BITBASE "\"\n"
+    ".globl bitcheckersBitbaseEnd\n"
+    "bitcheckersBitbaseEnd:\n"
+    ".previous\n");
+
+extern "C" const uint64_t bitcheckersBitbase[];
+extern "C" const char bitcheckersBitbaseEnd[];
+#endif
+
+namespace checkers::egdb {
+    namespace {
+
+        /**
+         * <summary>
+         * The slices of the bitbase, by material, and where
+         * the bits of each begin.
+         * </summary>
+         *
+         * @struct Bitbase
+         */
+        struct Bitbase final {
+            std::vector<Slice> slices;
+            std::vector<const uint64_t*> bits;
+            int8_t slots[BitbasePieces + 1][BitbasePieces + 1]
+                        [BitbasePieces + 1][BitbasePieces + 1];
+
+            Bitbase() : slots() {
+                for(auto& a: slots) for(auto& b: a) for(auto& c: b)
+                    for(int8_t& d: c) d = -1;
+#if defined(BITCHECKERS_BITBASE)
+                const uint64_t* p = bitcheckersBitbase;
+                for(const Material& m: materials(BitbasePieces)) {
+                    slots[m.counts[White][Pawn]][m.counts[White][King]]
+                         [m.counts[Black][Pawn]][m.counts[Black][King]] =
+                            (int8_t) slices.size();
+                    slices.emplace_back(m);
+                    bits.push_back(p);
+                    p += (slices.back().size() + 63) / 64;
+                }
+                // A bitbase of some other layout is of no use.
+                if((const char*) p != bitcheckersBitbaseEnd) {
+                    slices.clear();
+                    bits.clear();
+                    for(auto& a: slots) for(auto& b: a) for(auto& c: b)
+                        for(int8_t& d: c) d = -1;
+                }
+#endif
+            }
+        };
+
+        /** The bitbase, laid out on first use. */
+        const Bitbase& bitbase() {
+            static const Bitbase b;
+            return b;
+        }
+    }
+
+    bool hasBitbase() { return !bitbase().slices.empty(); }
+
+    bool probeBitbase(const Board& b, bool& win) {
+        const Material m = Material::of(b);
+        if(m.total() > BitbasePieces) return false;
+        const Bitbase& t = bitbase();
+        const int s = t.slots[m.counts[White][Pawn]][m.counts[White][King]]
+                             [m.counts[Black][Pawn]][m.counts[Black][King]];
+        if(s < 0) return false;
+        const uint64_t i = t.slices[s].index(b);
+        win = t.bits[s][i >> 6U] >> (i & 63U) & 1U;
+        return true;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef BITCHECKERS_BITBASE_H
+#define BITCHECKERS_BITBASE_H
+
+#include "egdb.h"
+
+namespace checkers::egdb {
+
+    /** The most pieces of a position in the embedded bitbase. */
+    constexpr int BitbasePieces = 4;
+
+    /**
+     * A method to find out whether or not the engine was built
+     * with a bitbase.
+     *
+     * @return whether or not a bitbase is embedded
+     */
+    bool hasBitbase();
+
+    /**
+     * <summary>
+     *  <p>
+     * A method to look up a position in the bitbase linked into
+     * the engine, which holds one bit for every position of up
+     * to four pieces: whether or not the player to move wins.
+     *  </p>
+     *  <p>
+     * A position that is not won is either lost or drawn, and
+     * so worth at most a draw. The search tells the two apart
+     * one ply later, as a position is lost when every move
+     * leads to a win for the opponent.
+     *  </p>
+     * </summary>
+     *
+     * @param b the board to look up, with no multi-jump in
+     * progress
+     * @param win whether or not the player to move wins, to
+     * fill if the position is held
+     * @return whether or not the bitbase holds the position
+     */
+    bool probeBitbase(const Board& b, bool& win);
+}
+
+#endif //BITCHECKERS_BITBASE_H
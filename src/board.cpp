@@ -5,5 +5,122 @@
 #include "board.h"
 
 namespace checkers {
+    namespace {
 
-}
\ No newline at end of file
+        /**
+         * A method to check whether the given piece has a
+         * jump available.
+         *
+         * @tparam A the alliance of the piece
+         * @param b a bitboard holding the piece
+         * @param king whether or not the piece is a king
+         * @param enemies the enemy pieces
+         * @param empty the empty squares
+         * @return whether or not the piece may jump
+         */
+        template<Alliance A>
+        constexpr bool canJump(const uint64_t b, const bool king,
+                               const uint64_t enemies,
+                               const uint64_t empty) {
+            constexpr const Defaults* x = getDefaults<A>();
+            return jumpTargets<x->upLeft>(b, enemies, empty) |
+                   jumpTargets<x->upRight>(b, enemies, empty) |
+                   (king? jumpTargets<x->downLeft>(b, enemies, empty) |
+                          jumpTargets<x->downRight>(b, enemies, empty)
+                          : 0);
+        }
+    }
+
+    void Board::applyMove(const Move m, State& s) {
+        const Alliance us = currentPlayerAlliance, them = ~us;
+        const int from = m.origin(), to = m.destination();
+        const PieceType pt = mailbox[from];
+        const uint64_t fromTo =
+                SquareToBitBoard[from] | SquareToBitBoard[to];
+        assert(pt != NullPT);
+        uint64_t k = currentState->key;
+        int v = currentState->psq;
+        if(currentState->jumper)
+            k ^= Zobrist.jumper[bitScanFwd(currentState->jumper)];
+        s.prevState = currentState;
+        s.capturedPiece = NullPT;
+        s.lastMove = m;
+        s.promoted = false;
+        s.jumper = 0;
+        currentState = &s;
+        pieces[us][pt]     ^= fromTo;
+        pieces[us][NullPT] ^= fromTo;
+        mailbox[from] = NullPT;
+        mailbox[to]   = pt;
+        k ^= Zobrist.pieces[us][pt][from] ^ Zobrist.pieces[us][pt][to];
+        v += PieceSquare.values[us][pt][to] -
+             PieceSquare.values[us][pt][from];
+        if(m.moveType() == Aggressive) {
+            const int cap = (from + to) >> 1U;
+            const PieceType cpt = mailbox[cap];
+            assert(cpt != NullPT);
+            pieces[them][cpt]    ^= SquareToBitBoard[cap];
+            pieces[them][NullPT] ^= SquareToBitBoard[cap];
+            mailbox[cap] = NullPT;
+            s.capturedPiece = cpt;
+            k ^= Zobrist.pieces[them][cpt][cap];
+            v -= PieceSquare.values[them][cpt][cap];
+        }
+        if(pt == Pawn && (SquareToBitBoard[to] & (us == White?
+                WhiteHighPromotionMask: BlackHighPromotionMask))) {
+            pieces[us][Pawn] ^= SquareToBitBoard[to];
+            pieces[us][King] ^= SquareToBitBoard[to];
+            mailbox[to] = King;
+            s.promoted = true;
+            k ^= Zobrist.pieces[us][Pawn][to] ^
+                 Zobrist.pieces[us][King][to];
+            v += PieceSquare.values[us][King][to] -
+                 PieceSquare.values[us][Pawn][to];
+        }
+        allPieces = pieces[White][NullPT] | pieces[Black][NullPT];
+        if(s.capturedPiece != NullPT && !s.promoted && (us == White?
+                canJump<White>(SquareToBitBoard[to], pt == King,
+                               pieces[them][NullPT], ~allPieces):
+                canJump<Black>(SquareToBitBoard[to], pt == King,
+                               pieces[them][NullPT], ~allPieces))) {
+            // The multi-jump continues: the turn does not pass.
+            s.jumper = SquareToBitBoard[to];
+            k ^= Zobrist.jumper[to];
+        } else {
+            currentPlayerAlliance = them;
+            k ^= Zobrist.side;
+        }
+        s.key = k;
+        s.psq = v;
+    }
+
+    void Board::retractMove(const Move m) {
+        const Alliance us = currentState->jumper?
+                currentPlayerAlliance: ~currentPlayerAlliance,
+                them = ~us;
+        const int from = m.origin(), to = m.destination();
+        const uint64_t fromTo =
+                SquareToBitBoard[from] | SquareToBitBoard[to];
+        if(currentState->promoted) {
+            pieces[us][King] ^= SquareToBitBoard[to];
+            pieces[us][Pawn] ^= SquareToBitBoard[to];
+            mailbox[to] = Pawn;
+        }
+        const PieceType pt = mailbox[to];
+        pieces[us][pt]     ^= fromTo;
+        pieces[us][NullPT] ^= fromTo;
+        mailbox[to]   = NullPT;
+        mailbox[from] = pt;
+        if(currentState->capturedPiece != NullPT) {
+            const int cap = (from + to) >> 1U;
+            const PieceType cpt = currentState->capturedPiece;
+            pieces[them][cpt]    ^= SquareToBitBoard[cap];
+            pieces[them][NullPT] ^= SquareToBitBoard[cap];
+            mailbox[cap] = cpt;
+        }
+        allPieces = pieces[White][NullPT] | pieces[Black][NullPT];
+        currentPlayerAlliance = us;
+        currentState = currentState->prevState;
+    }
+
+}
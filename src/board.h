@@ -6,6 +6,7 @@
 #define BITCHECKERS_BOARD_H
 
 #include "utility.h"
+#include "move.h"
 
 using std::ostream;
 
@@ -39,6 +40,40 @@ namespace checkers {
          * The captured piece for this State.
          */
         PieceType capturedPiece;
+
+        /**
+         * @private
+         * Whether or not the move leading to this State
+         * promoted a pawn.
+         */
+        bool promoted;
+
+        /**
+         * @private
+         * The move leading to this State.
+         */
+        Move lastMove;
+
+        /**
+         * @private
+         * The Zobrist key of the board in this State.
+         */
+        uint64_t key;
+
+        /**
+         * @private
+         * A bitboard holding the piece that must continue
+         * a multi-jump, or zero if the turn has passed.
+         */
+        uint64_t jumper;
+
+        /**
+         * @private
+         * The sum of the piece-square values of every piece
+         * on the board in this State, from White's point of
+         * view.
+         */
+        int psq;
     public:
 
         /**
@@ -46,8 +81,42 @@ namespace checkers {
          */
         constexpr State() :
                 prevState(nullptr),
-                capturedPiece(NullPT)
+                capturedPiece(NullPT),
+                promoted(false),
+                lastMove(NullMove),
+                key(0),
+                jumper(0),
+                psq(0)
         {  }
+
+        /**
+         * A method to expose the move leading to this State.
+         *
+         * @return the move leading to this State
+         */
+        [[nodiscard]]
+        constexpr Move previousMove() const
+        { return lastMove; }
+
+        /**
+         * A method to expose the piece captured by the move
+         * leading to this State.
+         *
+         * @return the type of the captured piece, or NullPT
+         */
+        [[nodiscard]]
+        constexpr PieceType capturedPieceType() const
+        { return capturedPiece; }
+
+        /**
+         * A method to check whether the move leading to this
+         * State promoted a pawn.
+         *
+         * @return whether or not the move promoted a pawn
+         */
+        [[nodiscard]]
+        constexpr bool isPromotion() const
+        { return promoted; }
     };
 
     class Board final {
@@ -111,7 +180,8 @@ namespace checkers {
          * @return a piece bitboard
          */
         template<Alliance A, PieceType PT>
-        constexpr uint64_t getPieces()
+        [[nodiscard]]
+        constexpr uint64_t getPieces() const
         { return pieces[A][PT]; }
 
         /**
@@ -124,9 +194,23 @@ namespace checkers {
          * to the given alliance
          */
         template<Alliance A>
-        constexpr uint64_t getPieces()
+        [[nodiscard]]
+        constexpr uint64_t getPieces() const
         { return pieces[A][NullPT]; }
 
+        /**
+         * A method to expose each piece bitboard.
+         *
+         * @param a the alliance of the bitboard
+         * @param pt the piece type of the bitboard, or NullPT
+         * for all pieces of the given alliance
+         * @return a piece bitboard
+         */
+        [[nodiscard]]
+        constexpr uint64_t getPieces(const Alliance a,
+                                     const PieceType pt) const
+        { return pieces[a][pt]; }
+
         /**
          * A method to pop each bit off of the given bitboard,
          * inserting the given character into the corresponding
@@ -202,6 +286,9 @@ namespace checkers {
         /** @public Deleted move constructor. */
         Board(Board&&) = default;
 
+        /** @public Default copy assignment operator. */
+        Board& operator=(const Board&) = default;
+
         /**
          * <summary>
          *  <p><br/>
@@ -403,6 +490,47 @@ namespace checkers {
             }
             allPieces =
                     pieces[White][NullPT] | pieces[Black][NullPT];
+            currentState->jumper = 0;
+            currentState->key = computeKey();
+            currentState->psq = computePieceSquareScore();
+        }
+
+        /**
+         * @private
+         * A method to compute the Zobrist key of this board
+         * from scratch.
+         *
+         * @return the Zobrist key of this board
+         */
+        [[nodiscard]]
+        constexpr uint64_t computeKey() const {
+            uint64_t k = currentPlayerAlliance == Black?
+                    Zobrist.side: 0;
+            for(int a = White; a <= Black; ++a)
+                for(int pt = Pawn; pt < NullPT; ++pt)
+                    for(uint64_t x = pieces[a][pt]; x; x &= x - 1)
+                        k ^= Zobrist.pieces[a][pt][bitScanFwd(x)];
+            if(currentState->jumper)
+                k ^= Zobrist.jumper[bitScanFwd(currentState->jumper)];
+            return k;
+        }
+
+        /**
+         * @private
+         * A method to compute the piece-square score of this
+         * board from scratch.
+         *
+         * @return the piece-square score of this board, from
+         * White's point of view
+         */
+        [[nodiscard]]
+        constexpr int computePieceSquareScore() const {
+            int v = 0;
+            for(int a = White; a <= Black; ++a)
+                for(int pt = Pawn; pt < NullPT; ++pt)
+                    for(uint64_t x = pieces[a][pt]; x; x &= x - 1)
+                        v += PieceSquare.values[a][pt][bitScanFwd(x)];
+            return v;
         }
     public:
 
@@ -413,6 +541,81 @@ namespace checkers {
         [[nodiscard]]
         constexpr PieceType getPiece(const int square) const
         { return mailbox[square]; }
+
+        /**
+         * A method to expose the current state.
+         *
+         * @return the current state
+         */
+        [[nodiscard]]
+        constexpr const State* getState() const
+        { return currentState; }
+
+        /**
+         * A method to expose the Zobrist key of this board.
+         *
+         * @return the Zobrist key of this board
+         */
+        [[nodiscard]]
+        constexpr uint64_t getKey() const
+        { return currentState->key; }
+
+        /**
+         * A method to expose the sum of the material and
+         * piece-square values of every piece on this board,
+         * which is kept up to date as moves are applied.
+         *
+         * @return the piece-square score, from White's point
+         * of view
+         */
+        [[nodiscard]]
+        constexpr int getPieceSquareScore() const
+        { return currentState->psq; }
+
+        /**
+         * A method to expose the piece that must continue a
+         * multi-jump.
+         *
+         * @return a bitboard holding the piece that must
+         * continue a multi-jump, or zero if any piece may move
+         */
+        [[nodiscard]]
+        constexpr uint64_t getJumper() const
+        { return currentState->jumper; }
+
+        /**
+         * A method to detach this board from its state stack,
+         * copying the current state into the given one. The
+         * board no longer depends on any earlier state, so
+         * moves before the current state may not be retracted.
+         *
+         * @param s the state to copy the current state into
+         */
+        constexpr void detach(State& s) {
+            s = *currentState;
+            s.prevState = nullptr;
+            currentState = &s;
+        }
+
+        /**
+         * A method to apply the given move to this board,
+         * pushing the given State onto the state stack.
+         *
+         * @param m the move to apply
+         * @param s an externally-allocated State to hold
+         * the information needed to retract the move
+         */
+        void applyMove(Move m, State& s);
+
+        /**
+         * A method to retract the given move from this
+         * board, popping the current State off of the
+         * state stack.
+         *
+         * @param m the move to retract, which must be the
+         * last move applied
+         */
+        void retractMove(Move m);
     };
 
 }
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "book.h"
+#include "movegen.h"
+
+namespace checkers::book {
+    namespace {
+
+        /**
+         * The header of a book file.
+         *
+         * @struct FileHeader
+         */
+        struct FileHeader final {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t entries;
+        };
+
+        /**
+         * The most probes by interpolation before falling back
+         * to a binary search, should the keys not be spread
+         * evenly after all.
+         */
+        constexpr int InterpolationProbes = 8;
+
+        /**
+         * The size of a range below which a linear scan is
+         * cheaper than another probe.
+         */
+        constexpr size_t ScanRange = 8;
+    }
+
+    size_t write(const std::string& path, const Entry* const entries,
+                 const size_t n) {
+        std::ofstream out(path, std::ios::binary);
+        const FileHeader h { Book::Magic, Book::Version, n };
+        out.write((const char*) &h, sizeof(h));
+        out.write((const char*) entries, (std::streamsize)
+                  (n * sizeof(Entry)));
+        return out? sizeof(h) + n * sizeof(Entry): 0;
+    }
+
+    Book::Book() :
+            mapping(nullptr), mappingSize(0), entries(nullptr), count(0)
+    {  }
+
+    Book::~Book()
+    { close(); }
+
+    void Book::close() {
+        if(mapping) munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+        entries = nullptr;
+        count = 0;
+    }
+
+    bool Book::open(const std::string& path) {
+        close();
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st{};
+        const auto size = (size_t) (fstat(fd, &st) == 0? st.st_size: 0);
+        void* const p = size >= sizeof(FileHeader)?
+                mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0):
+                MAP_FAILED;
+        ::close(fd);
+        if(p == MAP_FAILED) return false;
+        const auto* const h = (const FileHeader*) p;
+        if(h->magic != Magic || h->version != Version ||
+           h->entries > (size - sizeof(FileHeader)) / sizeof(Entry)) {
+            munmap(p, size);
+            return false;
+        }
+        // Only the pages of probes are read in.
+        madvise(p, size, MADV_RANDOM);
+        mapping = p;
+        mappingSize = size;
+        entries = (const Entry*) (h + 1);
+        count = h->entries;
+        return true;
+    }
+
+    size_t Book::lowerBound(const uint64_t key) const {
+        // The answer lies in [lo, hi].
+        size_t lo = 0, hi = count;
+        for(int i = 0; i < InterpolationProbes && hi - lo > ScanRange;
+            ++i) {
+            const uint64_t first = entries[lo].key,
+                           last = entries[hi - 1].key;
+            if(key <= first) return lo;
+            if(key > last) return hi;
+            // Guess where the key falls between the keys at
+            // either end.
+            const auto pos = lo + (size_t) ((unsigned __int128)
+                    (key - first) * (hi - 1 - lo) / (last - first));
+            if(entries[pos].key < key) lo = pos + 1;
+            else hi = pos;
+        }
+        while(hi - lo > ScanRange) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if(entries[mid].key < key) lo = mid + 1;
+            else hi = mid;
+        }
+        while(lo < hi && entries[lo].key < key) ++lo;
+        return lo;
+    }
+
+    int Book::probe(Board& b, Entry* const out, const int max) const {
+        if(!count) return 0;
+        const uint64_t key = b.getKey();
+        size_t i = lowerBound(key);
+        if(i == count || entries[i].key != key) return 0;
+        Move legal[movegen::MaxMoves];
+        Move* const end = movegen::generate<All>(legal, &b);
+        int n = 0;
+        for(; i < count && entries[i].key == key && n < max; ++i)
+            if(std::find(legal, end, Move(entries[i].move)) != end)
+                out[n++] = entries[i];
+        return n;
+    }
+
+    Move Book::pick(Board& b, const uint64_t random) const {
+        Entry found[movegen::MaxMoves];
+        const int n = probe(b, found, movegen::MaxMoves);
+        uint64_t total = 0;
+        for(int i = 0; i < n; ++i) total += found[i].weight;
+        if(!total) return NullMove;
+        uint64_t r = random % total;
+        for(int i = 0; i < n; ++i) {
+            if(r < found[i].weight) return Move(found[i].move);
+            r -= found[i].weight;
+        }
+        return NullMove;
+    }
+}
@@ -0,0 +1,188 @@
+#ifndef BITCHECKERS_BOOK_H
+#define BITCHECKERS_BOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "board.h"
+
+namespace checkers::book {
+    using namespace utility;
+
+    /**
+     * <summary>
+     * A move of the book from a position, with what the games
+     * made of it. The results are those of the player making
+     * the move.
+     * </summary>
+     *
+     * @struct Entry
+     */
+    struct Entry final {
+
+        /** The key of the position. */
+        uint64_t key;
+
+        /** The manifest of the move. */
+        uint16_t move;
+
+        /**
+         * The weight of the move, the half points it scored,
+         * by which it is chosen.
+         */
+        uint16_t weight;
+
+        /** The number of games in which the move was made. */
+        uint32_t games;
+
+        /** The number of those games won. */
+        uint32_t wins;
+
+        /** The number of those games drawn. */
+        uint32_t draws;
+    };
+
+    static_assert(sizeof(Entry) == 24);
+
+    /**
+     * A method to write a book file.
+     *
+     * @param path the path of the file
+     * @param entries the entries, sorted by key, then by
+     * weight, heaviest first
+     * @param n the number of entries
+     * @return the size of the file in bytes, or zero if it
+     * could not be written
+     */
+    size_t write(const std::string& path, const Entry* entries, size_t n);
+
+    /**
+     * <summary>
+     *  <p>
+     * An opening book, mapped into memory so that the engines
+     * running on a machine share a single copy of it through
+     * the page cache.
+     *  </p>
+     *  <p>
+     * A file holds a header, the magic number and the version
+     * as 32-bit integers and the number of entries as a 64-bit
+     * integer, followed by the entries, sorted by key. As the
+     * keys are Zobrist keys, and so spread evenly, a position
+     * is found by interpolation search in a few probes. All is
+     * little-endian.
+     *  </p>
+     * </summary>
+     *
+     * @class Book
+     */
+    class Book final {
+    public:
+
+        /** The magic number at the start of a file. */
+        static constexpr uint32_t Magic = 0x4B424342; // "BCBK"
+
+        /** The version of the file format. */
+        static constexpr uint32_t Version = 1;
+
+    private:
+
+        /**
+         * @private
+         * The mapping of the file, or nullptr.
+         */
+        void* mapping;
+
+        /**
+         * @private
+         * The size of the mapping.
+         */
+        size_t mappingSize;
+
+        /**
+         * @private
+         * The entries of the book.
+         */
+        const Entry* entries;
+
+        /**
+         * @private
+         * The number of entries of the book.
+         */
+        size_t count;
+
+        /**
+         * @private
+         * A method to find the first entry of a position.
+         *
+         * @param key the key of the position
+         * @return the index of the first entry whose key is
+         * not less than the given key
+         */
+        [[nodiscard]]
+        size_t lowerBound(uint64_t key) const;
+
+    public:
+
+        /** A default constructor for an empty Book. */
+        Book();
+
+        /** A destructor, which unmaps the file. */
+        ~Book();
+
+        /** @public Deleted copy constructor. */
+        Book(const Book&) = delete;
+
+        /**
+         * A method to map a book file, replacing the one mapped
+         * before.
+         *
+         * @param path the path of the file
+         * @return whether or not the file was a valid book
+         */
+        bool open(const std::string& path);
+
+        /** A method to unmap the file. */
+        void close();
+
+        /**
+         * A method to expose the number of entries.
+         *
+         * @return the number of entries of the book
+         */
+        [[nodiscard]]
+        constexpr size_t size() const { return count; }
+
+        /**
+         * A method to expose the entries, sorted by key.
+         *
+         * @return the entries of the book
+         */
+        [[nodiscard]]
+        constexpr const Entry* data() const { return entries; }
+
+        /**
+         * A method to look up the moves of a position, leaving
+         * out any that is not legal, as may happen when the
+         * keys of two positions collide.
+         *
+         * @param b the board to look up
+         * @param out the entries to fill, heaviest first
+         * @param max the most entries to fill
+         * @return the number of entries filled
+         */
+        int probe(Board& b, Entry* out, int max) const;
+
+        /**
+         * A method to choose a move of a position at random,
+         * in proportion to the weights.
+         *
+         * @param b the board to look up
+         * @param random a random number
+         * @return the move, or NullMove if the book has none
+         * with any weight
+         */
+        Move pick(Board& b, uint64_t random) const;
+    };
+}
+
+#endif //BITCHECKERS_BOOK_H
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "board.h"
+#include "book.h"
+#include "fen.h"
+#include "movegen.h"
+#include "opponent.h"
+
+using namespace checkers;
+using namespace checkers::book;
+using namespace checkers::opponent;
+
+/*
+ * A tool to grow an opening book with the engine's own
+ * searches. The book is walked best first from the start
+ * position, each position weighed by the chance of reaching
+ * it when every move is chosen from the book in proportion to
+ * its weight. The likeliest positions not yet in the book are
+ * searched in parallel, one per thread, and the moves whose
+ * scores come within a margin of the best are added, weighed
+ * by how close they come. A forced move needs no search.
+ *
+ * usage: bookexpand <book> <positions> [depth] [threads] [nodes] [fen]
+ *
+ * The book is read if it exists, and is written back after
+ * every few positions and at the end, by replacing the file,
+ * so that a run may be stopped at any time and resumed from
+ * the last write with the same command. Moves added by search
+ * have no games. The walk starts from the engine's start
+ * position, or from the given FEN.
+ */
+namespace {
+
+    /** The depth of each search by default. */
+    constexpr int DefaultDepth = 12;
+
+    /** The most plies of the book, jumps counted one by one. */
+    constexpr int MaxBookPly = 32;
+
+    /** The number of variations searched in each position. */
+    constexpr int Variations = 4;
+
+    /** The most a move may score below the best to be added. */
+    constexpr int Margin = 30;
+
+    /** The weight of a move that scores as well as the best. */
+    constexpr int EngineWeight = 100;
+
+    /** The number of positions searched between writes. */
+    constexpr int CheckpointInterval = 64;
+
+    /** The size of the transposition table of each thread. */
+    constexpr size_t TableMegabytes = 16;
+
+    /**
+     * <summary>
+     * A position of the book tree, as the moves that lead to
+     * it from the start, and the chance of reaching it.
+     * </summary>
+     *
+     * @struct Node
+     */
+    struct Node final {
+        double chance;
+        std::vector<uint16_t> path;
+
+        bool operator<(const Node& o) const { return chance < o.chance; }
+    };
+
+    /** The entries of the book, by key. */
+    std::unordered_map<uint64_t, std::vector<Entry>> entries;
+
+    /**
+     * A method to replay the moves that lead to a node.
+     *
+     * @param root the start position
+     * @param path the moves to replay
+     * @param states the states of the moves, to fill
+     * @return the board of the node
+     */
+    Board replay(const Board& root, const std::vector<uint16_t>& path,
+                 std::vector<State>& states) {
+        states.resize(path.size());
+        Board b = root;
+        for(size_t i = 0; i < path.size(); ++i)
+            b.applyMove(Move(path[i]), states[i]);
+        return b;
+    }
+
+    /**
+     * A method to find the entries of a position whose moves
+     * are legal.
+     *
+     * @param b the board of the position
+     * @return the legal entries, or none if the position is
+     * not in the book
+     */
+    std::vector<Entry> legalEntries(Board& b) {
+        std::vector<Entry> found;
+        const auto it = entries.find(b.getKey());
+        if(it == entries.end()) return found;
+        Move legal[movegen::MaxMoves];
+        Move* const end = movegen::generate<All>(legal, &b);
+        for(const Entry& e: it->second)
+            if(std::find(legal, end, Move(e.move)) != end)
+                found.push_back(e);
+        return found;
+    }
+
+    /**
+     * A method to queue the children of a node, each with its
+     * share of the chance of the node.
+     *
+     * @param frontier the queue of nodes
+     * @param n the node
+     * @param moves the entries of the node
+     */
+    void queueChildren(std::priority_queue<Node>& frontier, const Node& n,
+                       const std::vector<Entry>& moves) {
+        double total = 0;
+        for(const Entry& e: moves) total += e.weight;
+        for(const Entry& e: moves) {
+            Node c { n.chance * (total > 0? e.weight / total:
+                                 1.0 / (double) moves.size()), n.path };
+            c.path.push_back(e.move);
+            frontier.push(std::move(c));
+        }
+    }
+
+    /**
+     * A method to find the moves to add for a position.
+     *
+     * @param search the search to use
+     * @param b the board of the position
+     * @param limits the limits of the search
+     * @return the entries to add
+     */
+    std::vector<Entry> expand(Search& search, Board& b,
+                              const SearchLimits& limits) {
+        const uint64_t key = b.getKey();
+        Move legal[movegen::MaxMoves];
+        Move* const end = movegen::generate<All>(legal, &b);
+        if(end - legal == 1)
+            return { { key, (uint16_t) legal[0].getManifest(),
+                       EngineWeight, 0, 0, 0 } };
+        search.setBoard(b);
+        search.think(limits);
+        int best = -Infinity;
+        for(int i = 0; i < search.variationCount(); ++i)
+            if(search.line(i).length)
+                best = std::max(best, search.line(i).score);
+        std::vector<Entry> found;
+        for(int i = 0; i < search.variationCount(); ++i) {
+            const PvLine& l = search.line(i);
+            if(!l.length || best - l.score > Margin) continue;
+            const int weight = EngineWeight *
+                    (Margin + 1 - (best - l.score)) / (Margin + 1);
+            found.push_back({ key, (uint16_t) l.moves[0].getManifest(),
+                              (uint16_t) std::max(1, weight), 0, 0, 0 });
+        }
+        return found;
+    }
+
+    /**
+     * A method to write the book, replacing the file only
+     * once the whole book is written.
+     *
+     * @param path the path of the book
+     * @return whether or not the book was written
+     */
+    bool save(const std::string& path) {
+        std::vector<Entry> all;
+        for(const auto& [key, v]: entries)
+            all.insert(all.end(), v.begin(), v.end());
+        std::sort(all.begin(), all.end(),
+            [](const Entry& a, const Entry& b) {
+                return a.key != b.key? a.key < b.key:
+                       a.weight != b.weight? a.weight > b.weight:
+                       a.games > b.games;
+            });
+        const std::string temporary = path + ".tmp";
+        return write(temporary, all.data(), all.size()) &&
+               !std::rename(temporary.c_str(), path.c_str());
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <book> <positions>"
+                     " [depth] [threads] [nodes] [fen]\n";
+        return 1;
+    }
+    const std::string path = argv[1];
+    const long positions = std::atol(argv[2]);
+    SearchLimits limits;
+    limits.depth = argc > 3 && std::atoi(argv[3]) > 0?
+            std::atoi(argv[3]): DefaultDepth;
+    const int threads = argc > 4 && std::atoi(argv[4]) > 0?
+            std::atoi(argv[4]):
+            (int) std::max(1U, std::thread::hardware_concurrency());
+    if(argc > 5) limits.nodes = std::strtoull(argv[5], nullptr, 10);
+
+    State rootState;
+    Board::Builder builder(rootState);
+    if(argc > 6 && !parseFen(argv[6], builder)) {
+        std::cerr << "Cannot read FEN " << argv[6] << '\n';
+        return 1;
+    }
+    const Board root = builder.build();
+
+    // Resume from the book as it was last written.
+    {
+        Book b;
+        if(b.open(path))
+            for(size_t i = 0; i < b.size(); ++i)
+                entries[b.data()[i].key].push_back(b.data()[i]);
+    }
+    std::cout << "entries " << entries.size() << " positions\n";
+
+    std::vector<std::unique_ptr<TranspositionTable>> tables;
+    std::vector<std::unique_ptr<Search>> searches;
+    SearchOptions options;
+    options.multiPV = Variations;
+    for(int t = 0; t < threads; ++t) {
+        tables.push_back(std::make_unique<TranspositionTable>
+                         (TableMegabytes));
+        searches.push_back(std::make_unique<Search>(root, *tables[t]));
+        searches[t]->setOptions(options);
+    }
+
+    std::priority_queue<Node> frontier;
+    frontier.push({ 1.0, {} });
+    std::unordered_set<uint64_t> seen;
+    long searched = 0, sinceWrite = 0;
+    while(searched < positions && !frontier.empty()) {
+        // Take the likeliest positions not yet in the book,
+        // walking through those that are.
+        std::vector<Node> batch;
+        while((int) batch.size() < threads && !frontier.empty()) {
+            Node n = frontier.top();
+            frontier.pop();
+            std::vector<State> states;
+            Board b = replay(root, n.path, states);
+            if(!seen.insert(b.getKey()).second) continue;
+            const std::vector<Entry> moves = legalEntries(b);
+            if(!moves.empty()) {
+                queueChildren(frontier, n, moves);
+                continue;
+            }
+            Move legal[movegen::MaxMoves];
+            if((int) n.path.size() >= MaxBookPly ||
+               movegen::generate<All>(legal, &b) == legal)
+                continue;
+            batch.push_back(std::move(n));
+        }
+
+        std::vector<std::vector<Entry>> results(batch.size());
+        std::atomic<size_t> next = 0;
+        std::vector<std::thread> pool;
+        for(int t = 0; t < threads; ++t)
+            pool.emplace_back([&, t] {
+                for(size_t i; (i = next.fetch_add(1)) < batch.size();) {
+                    std::vector<State> states;
+                    Board b = replay(root, batch[i].path, states);
+                    tables[t]->newSearch();
+                    results[i] = expand(*searches[t], b, limits);
+                }
+            });
+        for(std::thread& th: pool) th.join();
+
+        for(size_t i = 0; i < batch.size(); ++i) {
+            if(results[i].empty()) continue;
+            entries[results[i][0].key] = results[i];
+            queueChildren(frontier, batch[i], results[i]);
+        }
+        searched += (long) batch.size();
+        sinceWrite += (long) batch.size();
+        if(sinceWrite >= CheckpointInterval || searched >= positions ||
+           frontier.empty()) {
+            sinceWrite = 0;
+            if(!save(path)) {
+                std::cerr << "Cannot write " << path << '\n';
+                return 1;
+            }
+            std::cout << "searched " << searched << " book "
+                      << entries.size() << " frontier " << frontier.size()
+                      << std::endl;
+        }
+    }
+    return 0;
+}
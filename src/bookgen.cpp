@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "board.h"
+#include "book.h"
+#include "fen.h"
+#include "pdn.h"
+
+using namespace checkers;
+using namespace checkers::book;
+
+/*
+ * A builder of opening books from game collections. Every
+ * game is replayed up to the given ply, and each move made
+ * from each position is counted with the result of the game
+ * for the player who made it. Moves made in fewer games than
+ * the given number are left out.
+ *
+ * usage: bookgen <games> <output> [max ply] [min games]
+ *
+ * Each line of the games file holds a game: an optional FEN
+ * of the position it starts from, the moves in standard
+ * notation, move numbers such as "1." being skipped, and the
+ * result for White: "1-0", "0-1" or "1/2-1/2". Games with no
+ * result are skipped, as are the moves after one that is not
+ * legal. A games file whose name ends in ".pdn" is read as
+ * PDN instead, the result standing for the player to move at
+ * the start.
+ */
+namespace {
+
+    /** The deepest ply counted by default. */
+    constexpr int DefaultMaxPly = 40;
+
+    /** The most plies of a game replayed. */
+    constexpr int MaxGamePly = 512;
+
+    /**
+     * <summary>
+     * A move from a position, as the key of its counts.
+     * </summary>
+     *
+     * @struct PositionMove
+     */
+    struct PositionMove final {
+        uint64_t key;
+        uint16_t move;
+
+        bool operator==(const PositionMove&) const = default;
+    };
+
+    /**
+     * <summary>
+     * A hash of a move from a position.
+     * </summary>
+     *
+     * @struct PositionMoveHash
+     */
+    struct PositionMoveHash final {
+        size_t operator()(const PositionMove& p) const
+        { return p.key ^ p.move * 0x9E3779B97F4A7C15UL; }
+    };
+
+    /**
+     * <summary>
+     * The counts of a move from a position.
+     * </summary>
+     *
+     * @struct Counts
+     */
+    struct Counts final {
+        uint32_t games, wins, draws;
+    };
+
+    /** The counts of every move seen, by position and move. */
+    std::unordered_map<PositionMove, Counts, PositionMoveHash> counts;
+
+    /**
+     * A method to count a move from a position.
+     *
+     * @param b the board of the position
+     * @param m the move, a single step
+     * @param ours the half points scored by the player making
+     * the move
+     */
+    void countMove(const Board& b, const Move m, const int ours) {
+        Counts& c = counts[{ b.getKey(), (uint16_t) m.getManifest() }];
+        ++c.games;
+        c.wins += ours == 2;
+        c.draws += ours == 1;
+    }
+
+    /**
+     * A method to count the moves of one game of a PDN file.
+     *
+     * @param g the game
+     * @param maxPly the deepest ply counted
+     * @return whether or not the game had a result
+     */
+    bool countPdnGame(const pdn::Game& g, const int maxPly) {
+        if(g.points < 0) return false;
+        State states[pdn::MaxGameSteps];
+        Board b = *g.start;
+        const Alliance first = b.currentPlayer();
+        for(int i = 0, ply = 0; i < g.stepCount && ply < maxPly; ++i) {
+            const int ours = b.currentPlayer() == first? g.points:
+                             2 - g.points;
+            countMove(b, g.steps[i], ours);
+            b.applyMove(g.steps[i], states[i]);
+            ply += !b.getJumper();
+        }
+        return true;
+    }
+
+    /**
+     * A method to count the moves of one game.
+     *
+     * @param line the game
+     * @param maxPly the deepest ply counted
+     * @return whether or not the game had a result
+     */
+    bool countGame(const std::string& line, const int maxPly) {
+        std::istringstream in(line);
+        std::vector<std::string> tokens;
+        int points = UnknownResult;
+        for(std::string t; in >> t;) {
+            if(const int r = parseResult(t); r != NoResult) {
+                points = r;
+                break;
+            }
+            if(t.back() != '.') tokens.push_back(std::move(t));
+        }
+        if(points < 0) return false;
+
+        std::vector<State> states(std::min(maxPly, MaxGamePly) *
+                                  MaxMoveSteps + 1);
+        Board::Builder builder(states[0]);
+        size_t first = 0;
+        if(!tokens.empty() && tokens[0].find(':') != std::string::npos) {
+            if(!parseFen(tokens[0], builder)) return true;
+            first = 1;
+        }
+        Board b = builder.build();
+        int used = 1;
+        for(size_t i = first; i < tokens.size() &&
+            (int) (i - first) < std::min(maxPly, MaxGamePly); ++i) {
+            Move steps[MaxMoveSteps];
+            const int n = parseMove(tokens[i], b, steps);
+            if(!n) break;
+            const Alliance us = b.currentPlayer();
+            const int ours = us == White? points: 2 - points;
+            for(int j = 0; j < n; ++j) {
+                countMove(b, steps[j], ours);
+                b.applyMove(steps[j], states[used++]);
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        std::cerr << "usage: " << argv[0]
+                  << " <games> <output> [max ply] [min games]\n";
+        return 1;
+    }
+    const int maxPly = argc > 3? std::max(0, std::atoi(argv[3])):
+                       DefaultMaxPly;
+    const uint32_t minGames = argc > 4?
+            (uint32_t) std::max(1, std::atoi(argv[4])): 1;
+    const std::string path = argv[1];
+    size_t games = 0, skipped = 0;
+    if(path.size() > 4 && path.compare(path.size() - 4, 4, ".pdn") == 0) {
+        pdn::Reader reader;
+        const bool read = reader.readFile(path, [&](const pdn::Game& g) {
+            if(countPdnGame(g, maxPly)) ++games;
+            else ++skipped;
+        });
+        if(!read) {
+            std::cerr << "Cannot read " << path << '\n';
+            return 1;
+        }
+    } else {
+        std::ifstream in(path);
+        if(!in) {
+            std::cerr << "Cannot read " << path << '\n';
+            return 1;
+        }
+        for(std::string line; std::getline(in, line);) {
+            if(line.empty()) continue;
+            if(countGame(line, maxPly)) ++games;
+            else ++skipped;
+        }
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(counts.size());
+    for(const auto& [p, c]: counts) {
+        if(c.games < minGames) continue;
+        entries.push_back({ p.key, p.move, (uint16_t) std::min<uint32_t>
+                (2 * c.wins + c.draws, UINT16_MAX), c.games, c.wins,
+                c.draws });
+    }
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) {
+            return a.key != b.key? a.key < b.key:
+                   a.weight != b.weight? a.weight > b.weight:
+                   a.games > b.games;
+        });
+    const size_t bytes = write(argv[2], entries.data(), entries.size());
+    if(!bytes) {
+        std::cerr << "Cannot write " << argv[2] << '\n';
+        return 1;
+    }
+    std::cout << "games " << games << " skipped " << skipped
+              << " entries " << entries.size() << " bytes " << bytes
+              << '\n';
+    return 0;
+}
@@ -0,0 +1,259 @@
+#include <algorithm>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#include "egdb.h"
+
+namespace checkers::egdb {
+    namespace {
+
+        /** The groups of pieces, in the order they are placed. */
+        constexpr Alliance GroupAlliance[] = { White, Black, White, Black };
+        constexpr PieceType GroupType[] = { Pawn, Pawn, King, King };
+
+        /**
+         * The squares on which each alliance's pawns may stand,
+         * as bits of the playable squares.
+         */
+        constexpr uint32_t PawnSquares[] = { 0xFFFFFFF0U, 0x0FFFFFFFU };
+
+        /** The number of squares on which pawns may stand. */
+        constexpr int PawnRange = 28;
+
+        /** The number of playable squares on a rank. */
+        constexpr int RankSquares = 4;
+
+        /**
+         * A method to gather the playable squares of a bitboard
+         * into the low 32 bits, in the order of their numbers.
+         *
+         * @param b the bitboard to gather
+         * @return the playable squares of the bitboard
+         */
+        inline uint32_t compact(uint64_t b) {
+#if defined(__BMI2__)
+            return (uint32_t) _pext_u64(b, PlayableMask);
+#else
+            uint32_t c = 0;
+            for(; b; b &= b - 1) c |= 1U << (bitScanFwd(b) >> 1U);
+            return c;
+#endif
+        }
+
+        /**
+         * A method to scatter the playable squares back onto a
+         * bitboard, undoing compact.
+         *
+         * @param c the playable squares
+         * @return the bitboard of the squares
+         */
+        inline uint64_t scatter(uint32_t c) {
+#if defined(__BMI2__)
+            return _pdep_u64(c, PlayableMask);
+#else
+            uint64_t b = 0;
+            for(; c; c &= c - 1)
+                b |= SquareToBitBoard[numberToSquare(
+                        bitScanFwd(c) + 1)];
+            return b;
+#endif
+        }
+
+        /** The largest group whose subsets are tabulated. */
+        constexpr int TabulatedPieces = 4;
+
+        /**
+         * <summary>
+         * The subsets of up to four of the playable squares,
+         * in order of their rank. Ranked in colexicographic
+         * order, the subsets of each size are in the order of
+         * their bits read as integers, so they are listed with
+         * Gosper's hack.
+         * </summary>
+         *
+         * @struct SubsetTables
+         */
+        struct SubsetTables final {
+            uint32_t offsets[TabulatedPieces + 1];
+            uint32_t sets[1 + 32 + 496 + 4960 + 35960];
+
+            constexpr SubsetTables() : offsets(), sets() {
+                uint32_t n = 0;
+                for(int k = 0; k <= TabulatedPieces; ++k) {
+                    offsets[k] = n;
+                    const uint32_t count = Binomial(PlayableSquares, k);
+                    uint32_t x = (1U << (unsigned) k) - 1;
+                    for(uint32_t i = 0; i < count; ++i) {
+                        sets[n++] = x;
+                        if(!x) break;
+                        const uint32_t c = x & -x, r = x + c;
+                        x = (((r ^ x) >> 2U) / c) | r;
+                    }
+                }
+            }
+        };
+
+        /** The subset tables. */
+        constexpr SubsetTables Subsets;
+
+        /**
+         * A method to scatter the low bits of the given value
+         * onto the set bits of a mask, in order.
+         *
+         * @param bits the bits to scatter
+         * @param mask the bits to scatter onto
+         * @return the scattered bits
+         */
+        inline uint32_t deposit(uint32_t bits, uint32_t mask) {
+#if defined(__BMI2__)
+            return _pdep_u32(bits, mask);
+#else
+            // Open a gap at each square not in the mask, from
+            // the lowest up, until no bit lies above the next.
+            for(uint32_t skipped = ~mask; skipped; skipped &= skipped - 1) {
+                const uint32_t low = skipped & -skipped;
+                if(bits < low) break;
+                bits = (bits & (low - 1)) | (bits & -low) << 1U;
+            }
+            return bits;
+#endif
+        }
+
+        /**
+         * A method to rank a set of squares among the subsets
+         * of the same size of the squares not taken.
+         *
+         * @param set the squares to rank
+         * @param taken the squares skipped, none of which are
+         * in the set
+         * @return the rank of the set
+         */
+        inline uint64_t rank(uint32_t set, const uint32_t taken) {
+            uint64_t r = 0;
+            for(int i = 1; set; set &= set - 1, ++i) {
+                const uint32_t below = (set & -set) - 1;
+                r += Binomial(highBitCount(below & ~taken), i);
+            }
+            return r;
+        }
+
+        /**
+         * A method to compute the set of squares of a rank.
+         *
+         * @param r the rank to unrank
+         * @param k the number of squares in the set
+         * @param free the squares not taken, among which the
+         * set was ranked
+         * @param range the number of squares the set was
+         * ranked among, which may be more than are free
+         * @return the squares of the given rank, or zero if
+         * they lie beyond the free squares
+         */
+        inline uint32_t unrank(uint64_t r, int k, const uint32_t free,
+                               int range) {
+            uint32_t set = 0;
+            if(k <= TabulatedPieces)
+                set = Subsets.sets[Subsets.offsets[k] + r];
+            else for(; k > 0; --k) {
+                while(Binomial(--range, k) > r);
+                r -= Binomial(range, k);
+                set |= 1U << (unsigned) range;
+            }
+            // The set lies among the first squares not taken.
+            if((uint64_t) set >> (unsigned) highBitCount(free)) return 0;
+            return deposit(set, free);
+        }
+    }
+
+    Material Material::of(const Board& b) {
+        Material m{};
+        for(const Alliance a: { White, Black })
+            for(const PieceType pt: { Pawn, King })
+                m.counts[a][pt] = (uint8_t) highBitCount(b.getPieces(a, pt));
+        return m;
+    }
+
+    std::string Material::name() const {
+        std::string s;
+        for(const Alliance a: { White, Black })
+            for(const PieceType pt: { Pawn, King })
+                s.push_back((char) ('0' + counts[a][pt]));
+        return s;
+    }
+
+    std::vector<Material> materials(const int pieces) {
+        std::vector<Material> order;
+        for(int n = 2; n <= pieces; ++n) {
+            std::vector<Material> level;
+            for(int wp = 0; wp <= n; ++wp)
+                for(int wk = 0; wp + wk <= n; ++wk)
+                    for(int bp = 0; wp + wk + bp <= n; ++bp) {
+                        const int bk = n - wp - wk - bp;
+                        if(wp + wk && bp + bk)
+                            level.push_back({{{(uint8_t) wp, (uint8_t) wk},
+                                              {(uint8_t) bp, (uint8_t) bk}}});
+                    }
+            std::stable_sort(level.begin(), level.end(),
+                [](const Material& a, const Material& b)
+                { return a.pawns() < b.pawns(); });
+            order.insert(order.end(), level.begin(), level.end());
+        }
+        return order;
+    }
+
+    Slice::Slice(const Material& m) :
+            material(m), groupRanges(), groupSizes(), slots(2) {
+        const int wp = m.counts[White][Pawn], bp = m.counts[Black][Pawn],
+                  wk = m.counts[White][King];
+        groupRanges[0] = PawnRange;
+        groupRanges[1] = PawnRange - std::max(0, wp - RankSquares);
+        groupRanges[2] = PlayableSquares - wp - bp;
+        groupRanges[3] = PlayableSquares - wp - bp - wk;
+        for(int g = 0; g < 4; ++g) {
+            groupSizes[g] = Binomial(groupRanges[g],
+                    m.counts[GroupAlliance[g]][GroupType[g]]);
+            slots *= groupSizes[g];
+        }
+    }
+
+    uint64_t Slice::index(const Board& b) const {
+        const uint32_t
+            wp = compact(b.getPieces<White, Pawn>()),
+            bp = compact(b.getPieces<Black, Pawn>()),
+            wk = compact(b.getPieces<White, King>()),
+            bk = compact(b.getPieces<Black, King>());
+        const uint64_t r[] = {
+            rank(wp, ~PawnSquares[White]),
+            rank(bp, ~PawnSquares[Black] | wp),
+            rank(wk, wp | bp),
+            rank(bk, wp | bp | wk)
+        };
+        uint64_t i = 0;
+        for(int g = 3; g >= 0; --g)
+            i = i * groupSizes[g] + r[g];
+        return b.currentPlayer() * (slots >> 1U) + i;
+    }
+
+    bool Slice::position(uint64_t index, uint64_t pieces[2][2],
+                         Alliance& side) const {
+        const uint64_t half = slots >> 1U;
+        side = index < half? White: Black;
+        if(side == Black) index -= half;
+        uint32_t taken = 0;
+        for(int g = 0; g < 4; ++g) {
+            const Alliance a = GroupAlliance[g];
+            const PieceType pt = GroupType[g];
+            const int k = material.counts[a][pt];
+            const uint32_t free = ~taken &
+                    (pt == Pawn? PawnSquares[a]: 0xFFFFFFFFU);
+            const uint64_t q = index / groupSizes[g];
+            const uint32_t set = unrank(index - q * groupSizes[g], k,
+                                        free, groupRanges[g]);
+            index = q;
+            if(k && !set) return false;
+            taken |= set;
+            pieces[a][pt] = scatter(set);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,199 @@
+#ifndef BITCHECKERS_EGDB_H
+#define BITCHECKERS_EGDB_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "board.h"
+
+namespace checkers::egdb {
+    using namespace utility;
+
+    /** The game-theoretic values of a position, enumerated. */
+    enum Value : uint8_t { Unknown, Win, Loss, Draw };
+
+    /**
+     * <summary>
+     * The number of pieces of each alliance and type in a
+     * slice of an endgame database.
+     * </summary>
+     *
+     * @struct Material
+     */
+    struct Material final {
+        uint8_t counts[2][2];
+
+        /**
+         * A method to count the pieces of a board.
+         *
+         * @param b the board to count
+         * @return the material of the board
+         */
+        static Material of(const Board& b);
+
+        /**
+         * A method to count the pieces of both alliances.
+         *
+         * @return the number of pieces
+         */
+        [[nodiscard]]
+        constexpr int total() const {
+            return counts[White][Pawn] + counts[White][King] +
+                   counts[Black][Pawn] + counts[Black][King];
+        }
+
+        /**
+         * A method to count the pawns of both alliances.
+         *
+         * @return the number of pawns
+         */
+        [[nodiscard]]
+        constexpr int pawns() const
+        { return counts[White][Pawn] + counts[Black][Pawn]; }
+
+        /**
+         * A method to pack this material into an integer, for
+         * use as a key.
+         *
+         * @return a unique key for this material
+         */
+        [[nodiscard]]
+        constexpr uint32_t key() const {
+            return counts[White][Pawn]       | counts[White][King] << 8U |
+                   counts[Black][Pawn] << 16U | counts[Black][King] << 24U;
+        }
+
+        /**
+         * A method to name this material, as the counts of
+         * White pawns, White kings, Black pawns and Black
+         * kings, such as "1102".
+         *
+         * @return the name of this material
+         */
+        [[nodiscard]]
+        std::string name() const;
+
+        constexpr bool operator==(const Material&) const = default;
+    };
+
+    /**
+     * A method to list every material of up to the given
+     * number of pieces with a piece on each side, in an order
+     * in which each capture or promotion leads to a material
+     * earlier in the list: by the number of pieces, then by
+     * the number of pawns.
+     *
+     * @param pieces the greatest number of pieces
+     * @return the materials, in order
+     */
+    std::vector<Material> materials(int pieces);
+
+    /**
+     * <summary>
+     *  <p>
+     * The positions of one material, each with either player
+     * to move, and a dense map between them and the integers
+     * from zero to the size of the slice.
+     *  </p>
+     *  <p>
+     * The groups of pieces are placed in turn: the White
+     * pawns, the Black pawns, the White kings, then the Black
+     * kings. Each group is ranked as a subset of the squares
+     * still free to it, with the squares taken by earlier
+     * groups skipped, so the kings waste no slots. Pawns never
+     * stand on their promotion rank, so each side's pawns
+     * range over 28 squares. The Black pawns are ranked among
+     * as many squares as the White pawns could leave them,
+     * which wastes only the slots of positions with fewer
+     * White pawns on Black's promotion rank than the most
+     * there could be. The positions with Black to move follow
+     * all of those with White to move, so that each half
+     * holds the values of one player and compresses into
+     * long runs.
+     *  </p>
+     * </summary>
+     *
+     * @class Slice
+     */
+    class Slice final {
+    private:
+
+        /**
+         * @private
+         * The material of this slice.
+         */
+        Material material;
+
+        /**
+         * @private
+         * The number of squares each group is ranked among,
+         * in the order they are placed.
+         */
+        int groupRanges[4];
+
+        /**
+         * @private
+         * The number of ranks of each group, in the order
+         * they are placed.
+         */
+        uint64_t groupSizes[4];
+
+        /**
+         * @private
+         * The number of indexes in this slice.
+         */
+        uint64_t slots;
+
+    public:
+
+        /**
+         * A public constructor for a Slice.
+         *
+         * @param m the material of the slice
+         */
+        explicit Slice(const Material& m);
+
+        /**
+         * A method to expose the material of this slice.
+         *
+         * @return the material of this slice
+         */
+        [[nodiscard]]
+        constexpr const Material& getMaterial() const
+        { return material; }
+
+        /**
+         * A method to expose the number of indexes in this
+         * slice.
+         *
+         * @return the number of indexes
+         */
+        [[nodiscard]]
+        constexpr uint64_t size() const { return slots; }
+
+        /**
+         * A method to compute the index of a board, which must
+         * have the material of this slice.
+         *
+         * @param b the board to index
+         * @return the index of the board
+         */
+        [[nodiscard]]
+        uint64_t index(const Board& b) const;
+
+        /**
+         * A method to compute the position of an index.
+         *
+         * @param index the index of the position
+         * @param pieces the piece bitboards to fill, by
+         * alliance and piece type
+         * @param side the player to move, to fill
+         * @return whether or not the index names a legal
+         * position
+         */
+        bool position(uint64_t index, uint64_t pieces[2][2],
+                      Alliance& side) const;
+    };
+}
+
+#endif //BITCHECKERS_EGDB_H
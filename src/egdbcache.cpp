@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstring>
+#include "egdbcache.h"
+
+namespace checkers::egdb {
+    namespace {
+
+        /**
+         * The memory a cached block costs beyond its values:
+         * its key, its list node and its map node, roughly.
+         */
+        constexpr size_t Overhead = 64;
+    }
+
+    BlockCache::BlockCache(const size_t megabytes) :
+            shards(std::make_unique<Shard[]>(Shards)),
+            shardCapacity(0)
+    { resize(megabytes); }
+
+    void BlockCache::resize(const size_t megabytes) {
+        clear();
+        shardCapacity = std::max<size_t>(1, (megabytes << 20U) /
+                (sizeof(Entry) + Overhead) / Shards);
+    }
+
+    void BlockCache::clear() {
+        for(int i = 0; i < Shards; ++i) {
+            Shard& s = shards[i];
+            std::lock_guard<std::mutex> g(s.lock);
+            s.entries.clear();
+            s.index.clear();
+            s.hits = s.misses = 0;
+        }
+    }
+
+    bool BlockCache::probe(const uint64_t key, const uint32_t offset,
+                           Value& v) {
+        Shard& s = shardOf(key);
+        std::lock_guard<std::mutex> g(s.lock);
+        const auto it = s.index.find(key);
+        if(it == s.index.end()) {
+            ++s.misses;
+            return false;
+        }
+        ++s.hits;
+        s.entries.splice(s.entries.begin(), s.entries, it->second);
+        v = Value((it->second->values[offset >> 2U] >>
+                   ((offset & 3U) << 1U)) & 3U);
+        return true;
+    }
+
+    void BlockCache::store(const uint64_t key, const uint8_t* const values) {
+        Shard& s = shardOf(key);
+        std::lock_guard<std::mutex> g(s.lock);
+        // Another thread may have decoded the same block.
+        if(s.index.count(key)) return;
+        if(s.entries.size() >= shardCapacity) {
+            // Reuse the node of the least recently used block.
+            s.index.erase(s.entries.back().key);
+            s.entries.splice(s.entries.begin(), s.entries,
+                             std::prev(s.entries.end()));
+        } else s.entries.emplace_front();
+        Entry& e = s.entries.front();
+        e.key = key;
+        std::memcpy(e.values, values, BlockBytes);
+        s.index.emplace(key, s.entries.begin());
+    }
+
+    uint64_t BlockCache::hits() const {
+        uint64_t n = 0;
+        for(int i = 0; i < Shards; ++i) {
+            std::lock_guard<std::mutex> g(shards[i].lock);
+            n += shards[i].hits;
+        }
+        return n;
+    }
+
+    uint64_t BlockCache::misses() const {
+        uint64_t n = 0;
+        for(int i = 0; i < Shards; ++i) {
+            std::lock_guard<std::mutex> g(shards[i].lock);
+            n += shards[i].misses;
+        }
+        return n;
+    }
+}
@@ -0,0 +1,165 @@
+#ifndef BITCHECKERS_EGDBCACHE_H
+#define BITCHECKERS_EGDBCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "egdbfile.h"
+
+namespace checkers::egdb {
+
+    /**
+     * <summary>
+     *  <p>
+     * A cache of decoded database blocks, least recently used
+     * first out, so that a search that keeps probing the same
+     * few blocks decodes each only once. It may be shared by
+     * several searches.
+     *  </p>
+     *  <p>
+     * The blocks are spread over shards by key, each with its
+     * own lock, list and map, so that threads probing
+     * different blocks seldom wait on each other. A block is
+     * kept with two bits per position.
+     *  </p>
+     * </summary>
+     *
+     * @class BlockCache
+     */
+    class BlockCache final {
+    public:
+
+        /** The number of shards. */
+        static constexpr int Shards = 16;
+
+        /** The number of bytes of a decoded block. */
+        static constexpr size_t BlockBytes = BlockPositions / 4;
+
+    private:
+
+        /**
+         * @private
+         * A decoded block and its key.
+         *
+         * @struct Entry
+         */
+        struct Entry final {
+            uint64_t key;
+            uint8_t values[BlockBytes];
+        };
+
+        /**
+         * @private
+         * The blocks of one shard, most recently used first.
+         *
+         * @struct Shard
+         */
+        struct Shard final {
+            std::mutex lock;
+            std::list<Entry> entries;
+            std::unordered_map<uint64_t,
+                               std::list<Entry>::iterator> index;
+            uint64_t hits = 0, misses = 0;
+        };
+
+        /**
+         * @private
+         * The shards of this cache.
+         */
+        std::unique_ptr<Shard[]> shards;
+
+        /**
+         * @private
+         * The number of blocks each shard may hold.
+         */
+        size_t shardCapacity;
+
+        /**
+         * @private
+         * A method to find the shard of a key.
+         *
+         * @param key the key of a block
+         * @return the shard of the block
+         */
+        Shard& shardOf(const uint64_t key) const
+        { return shards[(key * 0x9E3779B97F4A7C15UL) >> 60U]; }
+
+    public:
+
+        /**
+         * A public constructor for a BlockCache.
+         *
+         * @param megabytes the memory to use, rounded down to
+         * a whole number of blocks in each shard
+         */
+        explicit BlockCache(size_t megabytes);
+
+        /** @public Deleted copy constructor. */
+        BlockCache(const BlockCache&) = delete;
+
+        /**
+         * A method to change the memory used by this cache,
+         * clearing it.
+         *
+         * @param megabytes the new memory to use
+         */
+        void resize(size_t megabytes);
+
+        /** A method to empty this cache and its counters. */
+        void clear();
+
+        /**
+         * A method to look up a position in a cached block,
+         * marking the block as most recently used.
+         *
+         * @param key the key of the block
+         * @param offset the offset of the position in the
+         * block
+         * @param v the value of the position, to fill on a hit
+         * @return whether or not the block was cached
+         */
+        bool probe(uint64_t key, uint32_t offset, Value& v);
+
+        /**
+         * A method to cache a decoded block, evicting the least
+         * recently used block of its shard if the shard is
+         * full.
+         *
+         * @param key the key of the block
+         * @param values the values of the block, two bits per
+         * position, the lowest first
+         */
+        void store(uint64_t key, const uint8_t* values);
+
+        /**
+         * A method to count the probes that hit.
+         *
+         * @return the number of hits since the last clear
+         */
+        [[nodiscard]]
+        uint64_t hits() const;
+
+        /**
+         * A method to count the probes that missed.
+         *
+         * @return the number of misses since the last clear
+         */
+        [[nodiscard]]
+        uint64_t misses() const;
+
+        /**
+         * A method to expose the number of blocks this cache
+         * may hold.
+         *
+         * @return the capacity of this cache, in blocks
+         */
+        [[nodiscard]]
+        constexpr size_t capacity() const
+        { return shardCapacity * Shards; }
+    };
+}
+
+#endif //BITCHECKERS_EGDBCACHE_H
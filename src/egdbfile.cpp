@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <queue>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "egdbfile.h"
+#include "egdbcache.h"
+
+namespace checkers::egdb {
+    namespace {
+
+        /**
+         * The header of a compressed database file.
+         *
+         * @struct FileHeader
+         */
+        struct FileHeader final {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t material;
+            uint32_t blockPositions;
+            uint64_t positions;
+            uint64_t blocks;
+            uint8_t codeLengths[64];
+        };
+
+        /**
+         * The bytes of zeros after the last block, so that the
+         * reader may fill its window past the end.
+         */
+        constexpr int Padding = 8;
+
+        /**
+         * A method to check the header and offsets of a mapped
+         * file, so that a corrupt file is rejected rather than
+         * read out of bounds. The number of blocks must be that
+         * of the positions, the offsets must not decrease, the
+         * last of them and the padding must lie within the
+         * mapping, and the code lengths must form a prefix code.
+         *
+         * @param h the header, at the start of the mapping
+         * @param m the material of the file
+         * @param positions the number of positions of the slice
+         * @param size the size of the mapping in bytes
+         * @return whether or not the file may be read
+         */
+        bool valid(const FileHeader& h, const Material& m,
+                   const uint64_t positions, const size_t size) {
+            if(h.magic != Database::Magic || h.version != Database::Version ||
+               h.material != m.key() || h.blockPositions != BlockPositions ||
+               h.positions != positions ||
+               h.blocks != (positions + BlockPositions - 1) / BlockPositions)
+                return false;
+            const size_t start = sizeof(FileHeader) +
+                                 (h.blocks + 1) * sizeof(uint64_t);
+            if(size < start) return false;
+            const auto* const offsets = (const uint64_t*) (&h + 1);
+            for(uint64_t i = 0; i < h.blocks; ++i)
+                if(offsets[i] > offsets[i + 1]) return false;
+            if(size - start < Padding ||
+               offsets[h.blocks] > size - start - Padding)
+                return false;
+            // Kraft's inequality, so that no code overflows the
+            // decoding table.
+            uint32_t space = 0;
+            for(int s = 0; s < Symbols; ++s) {
+                const int len = h.codeLengths[s];
+                if(len > MaxCodeLength) return false;
+                if(len) space += 1U << (unsigned) (MaxCodeLength - len);
+            }
+            return space <= 1U << (unsigned) MaxCodeLength;
+        }
+
+        /**
+         * A method to compute the length class of a run.
+         *
+         * @param length the length of the run
+         * @return the power of two at or below the length
+         */
+        inline int lengthClass(const uint32_t length)
+        { return 31 - __builtin_clz(length); }
+
+        /**
+         * <summary>
+         * A writer of bits, most significant first.
+         * </summary>
+         *
+         * @struct BitWriter
+         */
+        struct BitWriter final {
+            std::vector<uint8_t>& out;
+            uint64_t window = 0;
+            int bits = 0;
+
+            void write(const uint32_t v, const int n) {
+                for(int i = n - 1; i >= 0; --i) {
+                    window = window << 1U | ((v >> (unsigned) i) & 1U);
+                    if(++bits == 8) {
+                        out.push_back((uint8_t) window);
+                        window = 0; bits = 0;
+                    }
+                }
+            }
+
+            void flush() { if(bits) write(0, 8 - bits); }
+        };
+
+        /**
+         * <summary>
+         * A reader of bits, most significant first, through a
+         * 64-bit window.
+         * </summary>
+         *
+         * @struct BitReader
+         */
+        struct BitReader final {
+            const uint8_t* p;
+            uint64_t window = 0;
+            int bits = 0;
+
+            inline void fill() {
+                for(; bits <= 56; bits += 8)
+                    window |= (uint64_t) *p++ << (unsigned) (56 - bits);
+            }
+
+            inline uint32_t peek(const int n) {
+                fill();
+                return (uint32_t) (window >> (unsigned) (64 - n));
+            }
+
+            inline void skip(const int n) {
+                window <<= (unsigned) n;
+                bits -= n;
+            }
+
+            inline uint32_t read(const int n) {
+                if(!n) return 0;
+                const uint32_t v = peek(n);
+                skip(n);
+                return v;
+            }
+        };
+
+        /**
+         * A method to call a function on each run of each
+         * block of the given values, with the indexes that
+         * name no legal position merged into the run around
+         * them.
+         *
+         * @param values the values to split
+         * @param f the function to call, given the block, the
+         * value and the length of each run
+         */
+        template<class F>
+        void forEachRun(const std::vector<uint8_t>& values, F f) {
+            const uint64_t n = values.size();
+            for(uint64_t b = 0; b < n; b += BlockPositions) {
+                const uint64_t e = std::min(n, b + BlockPositions);
+                uint8_t current = Draw;
+                for(uint64_t i = b; i < e; ++i)
+                    if(values[i] != Unknown) { current = values[i]; break; }
+                uint32_t length = 0;
+                for(uint64_t i = b; i < e; ++i) {
+                    if(values[i] == Unknown || values[i] == current) {
+                        ++length;
+                        continue;
+                    }
+                    f(b / BlockPositions, current, length);
+                    current = values[i];
+                    length = 1;
+                }
+                f(b / BlockPositions, current, length);
+            }
+        }
+
+        /**
+         * A method to compute the lengths of a Huffman code,
+         * flattening the frequencies until no code is longer
+         * than the longest allowed.
+         *
+         * @param freq the frequency of each symbol
+         * @param lengths the length of the code of each
+         * symbol, to fill; zero for symbols never used
+         */
+        void codeLengths(uint64_t freq[Symbols], uint8_t lengths[Symbols]) {
+            for(;;) {
+                std::vector<uint64_t> weight;
+                std::vector<int> parent;
+                using Node = std::pair<uint64_t, int>;
+                std::priority_queue<Node, std::vector<Node>,
+                                    std::greater<>> q;
+                for(int s = 0; s < Symbols; ++s) {
+                    weight.push_back(freq[s]);
+                    parent.push_back(-1);
+                    if(freq[s]) q.emplace(freq[s], s);
+                }
+                while(q.size() > 1) {
+                    const Node a = q.top(); q.pop();
+                    const Node b = q.top(); q.pop();
+                    const int id = (int) weight.size();
+                    weight.push_back(a.first + b.first);
+                    parent.push_back(-1);
+                    parent[a.second] = parent[b.second] = id;
+                    q.emplace(a.first + b.first, id);
+                }
+                int longest = 0;
+                for(int s = 0; s < Symbols; ++s) {
+                    int d = 0;
+                    if(freq[s])
+                        for(int x = s; parent[x] >= 0; x = parent[x]) ++d;
+                    // A lone symbol still needs a bit.
+                    lengths[s] = (uint8_t) (freq[s]? std::max(d, 1): 0);
+                    longest = std::max(longest, (int) lengths[s]);
+                }
+                if(longest <= MaxCodeLength) return;
+                for(int s = 0; s < Symbols; ++s)
+                    if(freq[s]) freq[s] = (freq[s] >> 1U) | 1U;
+            }
+        }
+    }
+
+    size_t compress(const std::string& path, const Slice& slice,
+                    const std::vector<uint8_t>& values) {
+        // Build a code from the runs of the whole slice.
+        uint64_t freq[Symbols] = {};
+        forEachRun(values, [&](uint64_t, const uint8_t v,
+                               const uint32_t length) {
+            ++freq[(v - Win) * LengthClasses + lengthClass(length)];
+        });
+        FileHeader h{};
+        codeLengths(freq, h.codeLengths);
+        uint32_t codes[Symbols] = {};
+        for(uint32_t code = 0, len = 1; len <= MaxCodeLength;
+            ++len, code <<= 1U)
+            for(int s = 0; s < Symbols; ++s)
+                if(h.codeLengths[s] == len) codes[s] = code++;
+
+        // Code each block, noting where it starts.
+        const uint64_t blocks =
+                (values.size() + BlockPositions - 1) / BlockPositions;
+        std::vector<uint64_t> offsets(blocks + 1);
+        std::vector<uint8_t> data;
+        BitWriter w { data };
+        uint64_t block = 0;
+        forEachRun(values, [&](const uint64_t b, const uint8_t v,
+                               const uint32_t length) {
+            if(b != block) {
+                w.flush();
+                offsets[block = b] = data.size();
+            }
+            const int c = lengthClass(length);
+            const int s = (v - Win) * LengthClasses + c;
+            w.write(codes[s], h.codeLengths[s]);
+            w.write(length - (1U << (unsigned) c), c);
+        });
+        w.flush();
+        offsets[blocks] = data.size();
+        data.resize(data.size() + Padding);
+
+        h.magic = Database::Magic;
+        h.version = Database::Version;
+        h.material = slice.getMaterial().key();
+        h.blockPositions = BlockPositions;
+        h.positions = values.size();
+        h.blocks = blocks;
+        std::ofstream out(path, std::ios::binary);
+        out.write((const char*) &h, sizeof(h));
+        out.write((const char*) offsets.data(),
+                  (std::streamsize) (offsets.size() * sizeof(uint64_t)));
+        out.write((const char*) data.data(), (std::streamsize) data.size());
+        return out? sizeof(h) + offsets.size() * sizeof(uint64_t) +
+                    data.size(): 0;
+    }
+
+    template<class F>
+    bool Database::File::decode(const uint64_t block, F f) const {
+        BitReader r { data + offsets[block] };
+        for(;;) {
+            int s = -1;
+            if(const uint16_t e = fast[r.peek(FastBits)]) {
+                s = e >> 5U;
+                r.skip(e & 31U);
+            } else {
+                // Canonical decoding: the codes of each length
+                // follow those of the length before.
+                int code = 0, first = 0, index = 0;
+                for(int len = 1; len <= MaxCodeLength; ++len) {
+                    code |= (int) r.read(1);
+                    const int count = counts[len];
+                    if(code - first < count) {
+                        s = symbols[index + code - first];
+                        break;
+                    }
+                    index += count;
+                    first = (first + count) << 1U;
+                    code <<= 1U;
+                }
+                if(s < 0) return false;
+            }
+            const int c = s % LengthClasses;
+            const uint32_t length = (1U << (unsigned) c) + r.read(c);
+            if(!f(Value(Win + s / LengthClasses), length)) return true;
+        }
+    }
+
+    Database::Database() : maxPieces(0), cache(nullptr)
+    {  }
+
+    Database::~Database()
+    { close(); }
+
+    void Database::close() {
+        for(auto& [key, f]: files) munmap(f.mapping, f.size);
+        files.clear();
+        maxPieces = 0;
+    }
+
+    bool Database::map(const std::string& path, const Material& m) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st{};
+        const auto size = (size_t) (fstat(fd, &st) == 0? st.st_size: 0);
+        void* const p = size >= sizeof(FileHeader)?
+                mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0):
+                MAP_FAILED;
+        ::close(fd);
+        if(p == MAP_FAILED) return false;
+        const auto* const h = (const FileHeader*) p;
+        File f { Slice(m), p, size, h->blocks, nullptr, nullptr, {}, {}, {} };
+        if(!valid(*h, m, f.slice.size(), size)) {
+            munmap(p, size);
+            return false;
+        }
+        f.offsets = (const uint64_t*) (h + 1);
+        f.data = (const uint8_t*) p + sizeof(FileHeader) +
+                 (h->blocks + 1) * sizeof(uint64_t);
+
+        // Sort the symbols by the length of their code, as the
+        // canonical decoder expects.
+        int n = 0;
+        for(int len = 1; len <= MaxCodeLength; ++len)
+            for(int s = 0; s < Symbols; ++s)
+                if(h->codeLengths[s] == len) {
+                    ++f.counts[len];
+                    f.symbols[n++] = (uint8_t) s;
+                }
+        // Fill the table with every code short enough, each
+        // under every pattern of the bits that may follow it.
+        for(uint32_t code = 0, len = 1; len <= FastBits;
+            ++len, code <<= 1U)
+            for(int k = 0; k < Symbols; ++k)
+                if(h->codeLengths[k] == len) {
+                    const unsigned spare = FastBits - len;
+                    for(uint32_t x = 0; x < 1U << spare; ++x)
+                        f.fast[code << spare | x] =
+                                (uint16_t) (k << 5U | len);
+                    ++code;
+                }
+        // Only the blocks of probes are paged in.
+        madvise(p, size, MADV_RANDOM);
+        files.insert_or_assign(m.key(), f);
+        maxPieces = std::max(maxPieces, m.total());
+        return true;
+    }
+
+    int Database::open(const std::string& dir, const int pieces) {
+        close();
+        int n = 0;
+        for(const Material& m: materials(pieces))
+            n += map(dir + '/' + m.name() + ".cdb", m);
+        return n;
+    }
+
+    Value Database::probe(const Board& b) const {
+        if(b.getJumper()) return Unknown;
+        const Material m = Material::of(b);
+        const Alliance us = b.currentPlayer();
+        if(!(m.counts[us][Pawn] + m.counts[us][King])) return Loss;
+        const auto it = files.find(m.key());
+        if(it == files.end()) return Unknown;
+        const File& f = it->second;
+        const uint64_t i = f.slice.index(b),
+                       block = i / BlockPositions;
+        const auto offset = (uint32_t) (i % BlockPositions);
+        Value v = Unknown;
+        if(!cache) {
+            uint32_t skip = offset;
+            f.decode(block, [&](const Value x, const uint32_t length) {
+                if(skip < length) { v = x; return false; }
+                skip -= length;
+                return true;
+            });
+            return v;
+        }
+
+        // Decode the whole block once for the probes to come.
+        const uint64_t key = (uint64_t) m.key() << 32U | block;
+        if(cache->probe(key, offset, v)) return v;
+        uint8_t values[BlockCache::BlockBytes] = {};
+        const uint64_t n = std::min<uint64_t>(BlockPositions,
+                f.slice.size() - block * BlockPositions);
+        uint32_t at = 0;
+        if(!f.decode(block, [&](const Value x, const uint32_t length) {
+            for(const uint32_t e = at + length; at < e; ++at)
+                values[at >> 2U] |= (uint8_t) (x << ((at & 3U) << 1U));
+            return at < n;
+        }) || at != n)
+            return Unknown;
+        cache->store(key, values);
+        return Value((values[offset >> 2U] >> ((offset & 3U) << 1U)) & 3U);
+    }
+}
@@ -0,0 +1,209 @@
+#ifndef BITCHECKERS_EGDBFILE_H
+#define BITCHECKERS_EGDBFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "egdb.h"
+
+namespace checkers::egdb {
+
+    class BlockCache;
+
+    /** The number of positions in a block. */
+    constexpr uint32_t BlockPositions = 4096;
+
+    /**
+     * The number of classes of run lengths, one for each
+     * power of two up to the number of positions in a block.
+     */
+    constexpr int LengthClasses = 13;
+
+    /** The number of symbols: a value and a length class. */
+    constexpr int Symbols = 3 * LengthClasses;
+
+    /** The longest code of a symbol, in bits. */
+    constexpr int MaxCodeLength = 16;
+
+    /** The number of bits decoded at once with a table. */
+    constexpr int FastBits = 10;
+
+    /**
+     * A method to write the values of a slice as a compressed
+     * database file.
+     *
+     * @param path the path of the file
+     * @param slice the slice of the values
+     * @param values the value of each index of the slice,
+     * Unknown for indexes that name no legal position
+     * @return the size of the file in bytes, or zero if it
+     * could not be written
+     */
+    size_t compress(const std::string& path, const Slice& slice,
+                    const std::vector<uint8_t>& values);
+
+    /**
+     * <summary>
+     *  <p>
+     * A set of compressed endgame database files, mapped into
+     * memory, which decodes only the block that holds the
+     * position probed.
+     *  </p>
+     *  <p>
+     * A file holds a header, the offset of each block, and the
+     * blocks. The header holds the magic number, the version,
+     * the material key and the number of positions in a block,
+     * as 32-bit integers, the number of positions and of
+     * blocks, as 64-bit integers, and the length of the code
+     * of each symbol, one byte each, padded to 64 bytes. The
+     * offsets are 64-bit, from the end of the offsets, with
+     * one more than there are blocks to mark the end of the
+     * last. All is little-endian.
+     *  </p>
+     *  <p>
+     * A block is a sequence of runs of one value, each coded
+     * as a symbol for its value and the power of two below its
+     * length, followed by the rest of its length in as many
+     * raw bits as that power. The symbols are coded with a
+     * canonical Huffman code for the whole file, most
+     * significant bit first, and decoded a few bits at a time
+     * with a table. Indexes that name no legal position take
+     * the value of the run they fall in, so they cost nothing.
+     *  </p>
+     * </summary>
+     *
+     * @class Database
+     */
+    class Database final {
+    public:
+
+        /** The magic number at the start of a file. */
+        static constexpr uint32_t Magic = 0x42444342; // "BCDB"
+
+        /** The version of the file format. */
+        static constexpr uint32_t Version = 1;
+
+    private:
+
+        /**
+         * <summary>
+         * A mapped file and the decoding table of its code.
+         * </summary>
+         *
+         * @struct File
+         */
+        struct File final {
+            Slice slice;
+            void* mapping;
+            size_t size;
+            uint64_t blocks;
+            const uint64_t* offsets;
+            const uint8_t* data;
+            uint16_t counts[MaxCodeLength + 1];
+            uint8_t symbols[Symbols];
+            uint16_t fast[1U << FastBits];
+
+            /**
+             * A method to decode the runs of a block in order,
+             * until the given function asks to stop.
+             *
+             * @param block the block to decode
+             * @param f the function to call with the value and
+             * length of each run, which returns whether or not
+             * to go on
+             * @return whether or not the block was decoded to
+             * its end or the stop
+             */
+            template<class F>
+            bool decode(uint64_t block, F f) const;
+        };
+
+        /**
+         * @private
+         * The mapped files, by material key.
+         */
+        std::unordered_map<uint32_t, File> files;
+
+        /**
+         * @private
+         * The greatest number of pieces of a mapped file.
+         */
+        int maxPieces;
+
+        /**
+         * @private
+         * The cache of decoded blocks, or nullptr to decode
+         * only as far as each probe needs.
+         */
+        BlockCache* cache;
+
+        /**
+         * @private
+         * A method to map a single file.
+         *
+         * @param path the path of the file
+         * @param m the material of the file
+         * @return whether or not the file was a valid
+         * database file for the material
+         */
+        bool map(const std::string& path, const Material& m);
+
+    public:
+
+        /** A default constructor for an empty Database. */
+        Database();
+
+        /** A destructor, which unmaps every file. */
+        ~Database();
+
+        /** @public Deleted copy constructor. */
+        Database(const Database&) = delete;
+
+        /**
+         * A method to map the files of every material of up to
+         * the given number of pieces found in a directory,
+         * replacing those mapped before.
+         *
+         * @param dir the directory of the files
+         * @param pieces the greatest number of pieces
+         * @return the number of files mapped
+         */
+        int open(const std::string& dir, int pieces);
+
+        /** A method to unmap every file. */
+        void close();
+
+        /**
+         * A method to expose the greatest number of pieces of
+         * a mapped file.
+         *
+         * @return the number of pieces, or zero if none are
+         * mapped
+         */
+        [[nodiscard]]
+        constexpr int pieces() const { return maxPieces; }
+
+        /**
+         * A method to change the cache of decoded blocks.
+         *
+         * @param c the cache to use, which must outlive this
+         * database and may be shared, or nullptr for none
+         */
+        constexpr void setCache(BlockCache* const c) { cache = c; }
+
+        /**
+         * A method to look up the value of a position.
+         *
+         * @param b the board to look up, with no multi-jump in
+         * progress
+         * @return the value for the player to move, or Unknown
+         * if no file holds the position
+         */
+        [[nodiscard]]
+        Value probe(const Board& b) const;
+    };
+}
+
+#endif //BITCHECKERS_EGDBFILE_H
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "board.h"
+#include "movegen.h"
+#include "egdb.h"
+#include "egdbfile.h"
+
+using namespace checkers;
+using namespace checkers::egdb;
+
+/*
+ * A generator for the endgame databases, by retrograde
+ * analysis. The slices are solved in order of the number of
+ * pieces, then of the number of pawns, so that every capture
+ * and promotion leads to a slice already solved. Within a
+ * slice, the positions whose every move leaves it are solved
+ * first, then the values are carried back one ply per pass
+ * through the quiet moves that stay in the slice, with the
+ * unmove generator. Each pass is split over the cores by
+ * index ranges.
+ *
+ * usage: egdbgen <max pieces> <output dir> [threads] [--dtw] [--raw]
+ *                [--bitbase]
+ *
+ * Each slice is written as <name>.cdb, a compressed database
+ * file, with --raw also as <name>.wld, one Value per index,
+ * and with --dtw as <name>.dtw, the distance in plies to the
+ * end of the game as a 16-bit integer per index, 0xFFFF for
+ * draws and illegal indexes. A win ends with the opponent to
+ * move and unable to; a loss with the player to move unable
+ * to. With --bitbase, the slices are instead packed into a
+ * single bitbase.bin, to be linked into the engine.
+ */
+namespace {
+
+    /** The number of indexes a thread claims at a time. */
+    constexpr uint64_t Chunk = 1 << 14;
+
+    /** The distance of a position not yet known. */
+    constexpr uint16_t None = 0xFFFF;
+
+    /** The flag of an index that names no legal position. */
+    constexpr uint8_t Illegal = 1;
+
+    /** The flag of a position with a move to a drawn slice. */
+    constexpr uint8_t DrawMove = 2;
+
+    /**
+     * <summary>
+     * A solved slice, kept in memory for the slices built
+     * upon it.
+     * </summary>
+     *
+     * @struct Table
+     */
+    struct Table final {
+        Slice slice;
+        std::vector<uint8_t> values;
+        std::vector<uint16_t> distances;
+    };
+
+    /**
+     * <summary>
+     * The state of an unsolved position.
+     * </summary>
+     *
+     * @struct Work
+     */
+    struct Work final {
+
+        /** The least distance of a win found so far. */
+        uint16_t pendingWin;
+
+        /** The greatest distance of a loss found so far. */
+        uint16_t lossBound;
+
+        /** The number of moves in the slice not yet won. */
+        uint8_t moves;
+
+        /** The flags of the position. */
+        uint8_t flags;
+    };
+
+    /** The solved tables, by material key. */
+    std::unordered_map<uint32_t, Table> tables;
+
+    /**
+     * A method to run a function over the indexes of a slice
+     * on several threads, each claiming chunks in turn.
+     *
+     * @param n the number of indexes
+     * @param threads the number of threads
+     * @param f the function to run, given the bounds of a
+     * chunk
+     */
+    template<class F>
+    void parallel(const uint64_t n, const int threads, F f) {
+        std::atomic<uint64_t> next = 0;
+        std::vector<std::thread> pool;
+        for(int t = 0; t < threads; ++t)
+            pool.emplace_back([&] {
+                for(uint64_t b; (b = next.fetch_add(Chunk)) < n;)
+                    f(b, std::min(n, b + Chunk));
+            });
+        for(std::thread& th: pool) th.join();
+    }
+
+    /**
+     * A method to build a board from piece bitboards.
+     *
+     * @param s the state of the board
+     * @param p the piece bitboards, by alliance and type
+     * @param side the player to move
+     * @return the board
+     */
+    Board makeBoard(State& s, const uint64_t p[2][2],
+                    const Alliance side) {
+        Board::Builder b(s);
+        b.setPieces<White, Pawn>(p[White][Pawn])
+         .setPieces<White, King>(p[White][King])
+         .setPieces<Black, Pawn>(p[Black][Pawn])
+         .setPieces<Black, King>(p[Black][King])
+         .setCurrentPlayer(side == White? 'w': 'b');
+        return b.build();
+    }
+
+    /**
+     * A method to call a function on the board after each
+     * full move of the given board, following every jump
+     * sequence to its end.
+     *
+     * @param b the board to move from
+     * @param f the function to call
+     * @return whether or not the board had any move
+     */
+    template<class F>
+    bool expand(Board& b, F& f) {
+        Move moves[movegen::MaxMoves];
+        Move* const end = movegen::generate<All>(moves, &b);
+        for(Move* m = moves; m < end; ++m) {
+            State s;
+            Board c = b;
+            c.applyMove(*m, s);
+            if(c.getJumper()) expand(c, f);
+            else f(c);
+        }
+        return end != moves;
+    }
+
+    /**
+     * A method to look up a position in the solved tables.
+     *
+     * @param b the board to look up
+     * @param value the value for the player to move, to fill
+     * @param distance the distance of the value, to fill
+     */
+    void lookup(const Board& b, Value& value, uint16_t& distance) {
+        const Material m = Material::of(b);
+        const Alliance us = b.currentPlayer();
+        if(!(m.counts[us][Pawn] + m.counts[us][King])) {
+            value = Loss; distance = 0;
+            return;
+        }
+        const Table& t = tables.at(m.key());
+        const uint64_t i = t.slice.index(b);
+        value = Value(t.values[i]);
+        distance = t.distances[i];
+    }
+
+    /**
+     * A method to lower an atomic distance.
+     *
+     * @param d the distance to lower
+     * @param v the new distance, if less
+     */
+    void lower(uint16_t& d, const uint16_t v) {
+        std::atomic_ref<uint16_t> a(d);
+        uint16_t old = a.load(std::memory_order_relaxed);
+        while(v < old && !a.compare_exchange_weak(old, v,
+                std::memory_order_relaxed));
+    }
+
+    /**
+     * A method to raise an atomic distance.
+     *
+     * @param d the distance to raise
+     * @param v the new distance, if greater
+     */
+    void raise(uint16_t& d, const uint16_t v) {
+        std::atomic_ref<uint16_t> a(d);
+        uint16_t old = a.load(std::memory_order_relaxed);
+        while(v > old && !a.compare_exchange_weak(old, v,
+                std::memory_order_relaxed));
+    }
+
+    /**
+     * A method to solve a slice, given every slice it leads
+     * to.
+     *
+     * @param m the material of the slice
+     * @param threads the number of threads
+     * @return the solved slice
+     */
+    Table solve(const Material& m, const int threads) {
+        Table t { Slice(m), {}, {} };
+        const uint64_t n = t.slice.size();
+        t.values.assign(n, Unknown);
+        t.distances.assign(n, None);
+        std::vector<Work> work(n);
+        std::atomic<uint16_t> horizon = 0;
+
+        // Count the moves that stay in the slice, and bound
+        // the value of each position by those that leave it.
+        parallel(n, threads, [&](const uint64_t b, const uint64_t e) {
+            uint16_t far = 0;
+            for(uint64_t i = b; i < e; ++i) {
+                Work& w = work[i];
+                w = { None, 0, 0, 0 };
+                uint64_t p[2][2];
+                Alliance side;
+                if(!t.slice.position(i, p, side)) {
+                    w.flags = Illegal;
+                    continue;
+                }
+                State s;
+                Board board = makeBoard(s, p, side);
+                auto f = [&](const Board& c) {
+                    if(Material::of(c) == m) { ++w.moves; return; }
+                    Value v; uint16_t d;
+                    lookup(c, v, d);
+                    if(v == Loss) w.pendingWin = std::min<uint16_t>
+                            (w.pendingWin, d + 1);
+                    else if(v == Win) w.lossBound = std::max<uint16_t>
+                            (w.lossBound, d + 1);
+                    else w.flags |= DrawMove;
+                };
+                expand(board, f);
+                far = std::max(far, w.pendingWin != None?
+                        w.pendingWin: w.lossBound);
+            }
+            for(uint16_t h = horizon.load(); far > h &&
+                !horizon.compare_exchange_weak(h, far););
+        });
+
+        // Settle the positions of each distance in turn, then
+        // carry them back to the positions that lead to them.
+        uint64_t settled = 1;
+        for(uint16_t k = 0; settled || k <= horizon; ++k) {
+            std::atomic<uint64_t> count = 0;
+            parallel(n, threads, [&](const uint64_t b, const uint64_t e) {
+                uint64_t c = 0;
+                for(uint64_t i = b; i < e; ++i) {
+                    const Work& w = work[i];
+                    if(t.values[i] != Unknown || w.flags & Illegal)
+                        continue;
+                    if(w.pendingWin == k) t.values[i] = Win;
+                    else if(w.pendingWin == None && !w.moves &&
+                            !(w.flags & DrawMove) && w.lossBound <= k)
+                        t.values[i] = Loss;
+                    else continue;
+                    t.distances[i] = k;
+                    ++c;
+                }
+                count += c;
+            });
+            settled = count;
+            if(!settled) continue;
+
+            parallel(n, threads, [&](const uint64_t b, const uint64_t e) {
+                for(uint64_t i = b; i < e; ++i) {
+                    if(t.distances[i] != k) continue;
+                    const Value v = Value(t.values[i]);
+                    uint64_t p[2][2];
+                    Alliance side;
+                    t.slice.position(i, p, side);
+                    State s;
+                    const Board board = makeBoard(s, p, side);
+                    Move moves[movegen::MaxMoves];
+                    Move* const end =
+                            movegen::generateUnmoves(moves, &board);
+                    const Alliance them = ~side;
+                    for(Move* u = moves; u < end; ++u) {
+                        const uint64_t
+                            from = SquareToBitBoard[u->origin()],
+                            to = SquareToBitBoard[u->destination()];
+                        const PieceType pt =
+                            p[them][King] & to? King: Pawn;
+                        uint64_t q[2][2];
+                        std::memcpy(q, p, sizeof(q));
+                        q[them][pt] ^= from | to;
+                        State qs;
+                        Board prev = makeBoard(qs, q, them);
+                        Move jumps[movegen::MaxMoves];
+                        if(movegen::generate<Aggressive>(jumps, &prev)
+                           != jumps) continue;
+                        const uint64_t j = t.slice.index(prev);
+                        if(v == Loss) lower(work[j].pendingWin, k + 1);
+                        else {
+                            std::atomic_ref<uint8_t>(work[j].moves)
+                                    .fetch_sub(1, std::memory_order_relaxed);
+                            raise(work[j].lossBound, k + 1);
+                        }
+                    }
+                }
+            });
+        }
+
+        // Whatever is left can be neither won nor lost.
+        for(uint64_t i = 0; i < n; ++i)
+            if(t.values[i] == Unknown && !(work[i].flags & Illegal))
+                t.values[i] = Draw;
+        return t;
+    }
+
+    /**
+     * A method to write a vector to a file.
+     *
+     * @param path the path of the file
+     * @param v the vector to write
+     * @return whether or not the file was written
+     */
+    template<class T>
+    bool write(const std::string& path, const std::vector<T>& v) {
+        std::ofstream out(path, std::ios::binary);
+        out.write((const char*) v.data(), (std::streamsize)
+                  (v.size() * sizeof(T)));
+        return (bool) out;
+    }
+
+    /**
+     * A method to append a slice to a bitbase, one bit per
+     * index, set if the player to move wins, padded to a whole
+     * word.
+     *
+     * @param bits the words of the bitbase
+     * @param values the values of the slice
+     * @return the number of bytes appended
+     */
+    size_t pack(std::vector<uint64_t>& bits,
+                const std::vector<uint8_t>& values) {
+        const size_t base = bits.size();
+        bits.resize(base + (values.size() + 63) / 64);
+        for(uint64_t i = 0; i < values.size(); ++i)
+            if(values[i] == Win)
+                bits[base + (i >> 6U)] |= 1ULL << (i & 63U);
+        return (bits.size() - base) * sizeof(uint64_t);
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        std::cerr << "usage: " << argv[0]
+                  << " <max pieces> <output dir> [threads] [--dtw] [--raw]"
+                     " [--bitbase]\n";
+        return 1;
+    }
+    const int pieces = std::atoi(argv[1]);
+    const std::string dir = argv[2];
+    int threads = (int) std::max(1U, std::thread::hardware_concurrency());
+    bool dtw = false, raw = false, bitbase = false;
+    for(int i = 3; i < argc; ++i) {
+        if(!std::strcmp(argv[i], "--dtw")) dtw = true;
+        else if(!std::strcmp(argv[i], "--raw")) raw = true;
+        else if(!std::strcmp(argv[i], "--bitbase")) bitbase = true;
+        else if(std::atoi(argv[i]) > 0) threads = std::atoi(argv[i]);
+    }
+    if(pieces < 2 || pieces > 8) {
+        std::cerr << "The number of pieces must be from 2 to 8\n";
+        return 1;
+    }
+
+    std::vector<uint64_t> bits;
+    for(const Material& m: materials(pieces)) {
+        const auto start = std::chrono::steady_clock::now();
+        Table t = solve(m, threads);
+        uint64_t counts[4] = {};
+        for(const uint8_t v: t.values) ++counts[v];
+        const std::string path = dir + '/' + m.name();
+        const size_t bytes = bitbase? pack(bits, t.values):
+                compress(path + ".cdb", t.slice, t.values);
+        if(!bytes || (raw && !write(path + ".wld", t.values)) ||
+           (dtw && !write(path + ".dtw", t.distances))) {
+            std::cerr << "Cannot write " << path << '\n';
+            return 1;
+        }
+        std::cout << m.name() << " positions " << t.slice.size()
+                  << " win " << counts[Win] << " loss " << counts[Loss]
+                  << " draw " << counts[Draw] << " bytes " << bytes
+                  << " time "
+                  << std::chrono::duration<double>
+                     (std::chrono::steady_clock::now() - start).count()
+                  << "s" << std::endl;
+        tables.emplace(m.key(), std::move(t));
+    }
+    if(bitbase && !write(dir + "/bitbase.bin", bits)) {
+        std::cerr << "Cannot write " << dir << "/bitbase.bin\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include "evalcache.h"
+
+namespace checkers::opponent {
+
+    EvalCache::EvalCache(const size_t megabytes) :
+            entries(nullptr),
+            mask(0)
+    { resize(megabytes); }
+
+    EvalCache::~EvalCache()
+    { delete[] entries; }
+
+    void EvalCache::resize(const size_t megabytes) {
+        const size_t bytes = (megabytes? megabytes: 1) << 20U;
+        size_t n = 1;
+        while((n << 1U) * sizeof(uint64_t) <= bytes) n <<= 1U;
+        delete[] entries;
+        entries = new std::atomic<uint64_t>[n];
+        mask = n - 1;
+        clear();
+    }
+
+    void EvalCache::clear() {
+        // An empty entry matches only the keys whose upper 48
+        // bits are zero, once in 2^48 positions.
+        for(uint64_t i = 0; i <= mask; ++i)
+            entries[i].store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef BITCHECKERS_EVALCACHE_H
+#define BITCHECKERS_EVALCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace checkers::opponent {
+
+    /**
+     * <summary>
+     *  <p>
+     * A direct-mapped cache of static evaluations, keyed by
+     * Zobrist key. It may be owned by a single search or
+     * shared by several.
+     *  </p>
+     *  <p>
+     * Each entry is a single 64-bit word holding the upper
+     * 48 bits of the key and the 16-bit score, so an entry is
+     * always read and written whole and no locks are needed.
+     * A cache filled by one evaluation must be cleared before
+     * it is used with another.
+     *  </p>
+     * </summary>
+     *
+     * @class EvalCache
+     */
+    class EvalCache final {
+    private:
+
+        /** @private The bits of an entry holding the key. */
+        static constexpr uint64_t KeyMask = ~(uint64_t) 0xFFFFU;
+
+        /**
+         * @private
+         * The entries of this cache.
+         */
+        std::atomic<uint64_t>* entries;
+
+        /**
+         * @private
+         * The number of entries, minus one (a mask).
+         */
+        uint64_t mask;
+
+    public:
+
+        /**
+         * A public constructor for an EvalCache.
+         *
+         * @param megabytes the size of the cache, rounded down
+         * to a power of two number of entries
+         */
+        explicit EvalCache(size_t megabytes);
+
+        /** A destructor for an EvalCache. */
+        ~EvalCache();
+
+        /** @public Deleted copy constructor. */
+        EvalCache(const EvalCache&) = delete;
+
+        /** @public Deleted copy assignment operator. */
+        EvalCache& operator=(const EvalCache&) = delete;
+
+        /**
+         * A method to reallocate this cache, clearing it.
+         *
+         * @param megabytes the new size of the cache
+         */
+        void resize(size_t megabytes);
+
+        /**
+         * A method to empty this cache.
+         */
+        void clear();
+
+        /**
+         * A method to look up the given key.
+         *
+         * @param key the key to look up
+         * @param score the score to fill on a hit
+         * @return whether or not the key was found
+         */
+        bool probe(const uint64_t key, int& score) const {
+            const uint64_t e =
+                    entries[key & mask].load(std::memory_order_relaxed);
+            if((e ^ key) & KeyMask) return false;
+            score = (int16_t) (uint16_t) e;
+            return true;
+        }
+
+        /**
+         * A method to store a static evaluation, replacing
+         * whatever was stored in its entry.
+         *
+         * @param key the key of the position
+         * @param score the score, which must fit in 16 bits
+         */
+        void store(const uint64_t key, const int score) {
+            entries[key & mask].store(
+                    (key & KeyMask) | (uint16_t) (int16_t) score,
+                    std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif //BITCHECKERS_EVALCACHE_H
@@ -0,0 +1,108 @@
+#include "evaluation.h"
+
+namespace checkers::opponent {
+    namespace {
+
+        /** The bonus for each pawn guarding the back rank. */
+        constexpr int BackRankValue = 8;
+
+        /** The bonus for each pawn in the center. */
+        constexpr int CenterValue = 4;
+
+        /**
+         * The bonus for a runaway pawn on the square before
+         * promotion, less RunawayStep for each further rank.
+         */
+        constexpr int RunawayValue = KingValue - PawnValue;
+
+        /** The loss in runaway value for each rank to go. */
+        constexpr int RunawayStep = 4;
+
+        /** The sixteen squares in the center of the board. */
+        constexpr uint64_t CenterMask = 0x00003C3C3C3C0000UL;
+
+        /** The back rank of each alliance. */
+        constexpr uint64_t BackRank[] = { Ranks[7], Ranks[0] };
+
+        /**
+         * A method to compute, for a pawn of the given
+         * alliance on each square, every square it could
+         * cross on its way to promotion: those on the ranks
+         * ahead of it, no further to either side than they
+         * are ahead.
+         *
+         * @param a the alliance of the pawn
+         * @param cones the cones to fill, one for each square
+         */
+        constexpr void makeCones(const Alliance a, uint64_t* const cones) {
+            for(int sq = 0; sq < BoardLength; ++sq) {
+                uint64_t c = 0;
+                for(int t = 0; t < BoardLength; ++t) {
+                    const int dr = a == White?
+                            (sq >> 3) - (t >> 3): (t >> 3) - (sq >> 3);
+                    const int df = (sq & 7) - (t & 7);
+                    if(dr > 0 && (df < 0? -df: df) <= dr)
+                        c |= SquareToBitBoard[t];
+                }
+                cones[sq] = c;
+            }
+        }
+
+        /**
+         * <summary>
+         * The promotion cone of a pawn of each alliance on
+         * each square.
+         * </summary>
+         *
+         * @struct PromotionCones
+         */
+        struct PromotionCones final {
+            uint64_t cones[2][BoardLength];
+            constexpr PromotionCones() : cones() {
+                makeCones(White, cones[White]);
+                makeCones(Black, cones[Black]);
+            }
+        };
+
+        /** The promotion cones. */
+        constexpr PromotionCones Cones;
+
+        /**
+         * A method to compute the positional terms of the
+         * given alliance that the piece-square table cannot
+         * express.
+         *
+         * @tparam A the alliance to score
+         * @param b the board to score
+         * @return the positional score of the given alliance
+         */
+        template<Alliance A>
+        constexpr int positional(const Board& b) {
+            constexpr Alliance Them = ~A;
+            const uint64_t pawns = b.getPieces<A, Pawn>(),
+                           enemies = b.getPieces<Them>();
+            int v = CenterValue * highBitCount(pawns & CenterMask);
+            // Guards matter only while there is something
+            // to guard against.
+            if(b.getPieces<Them, Pawn>())
+                v += BackRankValue *
+                     highBitCount(pawns & BackRank[A]);
+            // Enemy kings can chase down any pawn.
+            if(!b.getPieces<Them, King>())
+                for(uint64_t x = pawns; x; x &= x - 1) {
+                    const int sq = bitScanFwd(x);
+                    if(Cones.cones[A][sq] & enemies) continue;
+                    const int togo = A == White?
+                            sq >> 3: 7 - (sq >> 3);
+                    v += RunawayValue - RunawayStep * (togo - 1);
+                }
+            return v;
+        }
+    }
+
+    int evaluate(const Board& b) {
+        const int v = b.getPieceSquareScore() +
+                      positional<White>(b) - positional<Black>(b);
+        return b.currentPlayer() == White? v: -v;
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef BITCHECKERS_EVALUATION_H
+#define BITCHECKERS_EVALUATION_H
+
+#include "board.h"
+
+namespace checkers::opponent {
+    using namespace utility;
+
+    /**
+     * A method to evaluate the given board from the
+     * perspective of the current player. Material and
+     * piece-square values are kept up to date by the board
+     * itself; only the terms that depend on several pieces
+     * at once are computed here:
+     * <ul>
+     *  <li>back-rank guards, which keep enemy pawns from
+     *  promoting while the enemy still has pawns</li>
+     *  <li>pawns in the center of the board</li>
+     *  <li>runaway pawns, which no enemy piece stands in the
+     *  way of promoting</li>
+     * </ul>
+     *
+     * @param b the board to evaluate
+     * @return the score of the given board
+     */
+    int evaluate(const Board& b);
+}
+
+#endif //BITCHECKERS_EVALUATION_H
@@ -0,0 +1,236 @@
+#include "fen.h"
+#include "movegen.h"
+
+namespace checkers {
+    namespace {
+
+        /**
+         * A method to read a square number in standard
+         * notation from the front of the given text.
+         *
+         * @param s the text to read from, which is advanced
+         * past the number
+         * @return the number, or zero if there is none or it
+         * is out of range
+         */
+        int readNumber(std::string_view& s) {
+            int n = 0, digits = 0;
+            while(!s.empty() && s.front() >= '0' && s.front() <= '9'
+                  && digits < 3) {
+                n = n * 10 + (s.front() - '0');
+                s.remove_prefix(1);
+                ++digits;
+            }
+            return n >= 1 && n <= 32? n: 0;
+        }
+
+        /**
+         * A method to read the pieces of one player, such as
+         * "W21,22,K30" or "B1-12".
+         *
+         * @param s the pieces to read
+         * @param b the builder to fill
+         * @param seen the squares already filled, to which the
+         * squares read are added
+         * @return whether or not the pieces could be read
+         */
+        bool readPieces(std::string_view s, Board::Builder& b,
+                        uint64_t& seen) {
+            if(s.empty() || (s.front() != 'W' && s.front() != 'B'))
+                return false;
+            const Alliance a = s.front() == 'W'? White: Black;
+            s.remove_prefix(1);
+            while(!s.empty()) {
+                const bool king = s.front() == 'K';
+                if(king) s.remove_prefix(1);
+                const int first = readNumber(s);
+                int last = first;
+                if(!s.empty() && s.front() == '-') {
+                    s.remove_prefix(1);
+                    last = readNumber(s);
+                }
+                if(!first || last < first) return false;
+                for(int n = first; n <= last; ++n) {
+                    const int sq = numberToSquare(n);
+                    if(seen & SquareToBitBoard[sq]) return false;
+                    seen |= SquareToBitBoard[sq];
+                    b.setPiece(a, king? King: Pawn, sq);
+                }
+                if(!s.empty()) {
+                    if(s.front() != ',') return false;
+                    s.remove_prefix(1);
+                }
+            }
+            return true;
+        }
+
+        /**
+         * A method to write the pieces of one player.
+         *
+         * @param out the string to append to
+         * @param b the board to write
+         * @param a the player whose pieces to write
+         */
+        void writePieces(std::string& out, const Board& b,
+                         const Alliance a) {
+            out.push_back(':');
+            out.push_back(a == White? 'W': 'B');
+            bool first = true;
+            for(uint64_t x = b.getPieces(a, NullPT); x; x &= x - 1) {
+                const int sq = bitScanFwd(x);
+                if(!first) out.push_back(',');
+                first = false;
+                if(b.getPiece(sq) == King) out.push_back('K');
+                out.append(std::to_string(squareToNumber(sq)));
+            }
+        }
+
+        /**
+         * A method to find the steps of a move that pass
+         * through the given squares in order, landing on the
+         * last as the move ends.
+         *
+         * @param b the board, with the moving piece on the
+         * square of the step before
+         * @param squares the squares named, from the origin
+         * @param n the number of squares
+         * @param next the index of the next square to land on
+         * @param moves the moves to fill
+         * @param step the index of the move to fill
+         * @return the number of moves of the whole move, or
+         * zero if none fits
+         */
+        int matchSteps(Board& b, const int* squares, const int n,
+                       const int next, Move* moves, const int step) {
+            if(step >= MaxMoveSteps) return 0;
+            Move legal[movegen::MaxMoves];
+            Move* const end = movegen::generate<All>(legal, &b);
+            const int from = step? moves[step - 1].destination():
+                                   squares[0];
+            for(Move* m = legal; m < end; ++m) {
+                if(m->origin() != from) continue;
+                const bool named = m->destination() == squares[next];
+                // Only the landing squares of jumps may be
+                // left out.
+                if(!named && !b.getJumper() &&
+                   m->moveType() != Aggressive)
+                    continue;
+                State s;
+                Board c = b;
+                c.applyMove(*m, s);
+                moves[step] = *m;
+                const int k = named? next + 1: next;
+                if(!c.getJumper()) {
+                    if(k == n) return step + 1;
+                } else if(k < n) {
+                    const int found =
+                            matchSteps(c, squares, n, k, moves, step + 1);
+                    if(found) return found;
+                }
+            }
+            return 0;
+        }
+    }
+
+    bool parseFen(std::string_view fen, Board::Builder& b) {
+        while(!fen.empty() && (fen.back() == '.' || fen.back() == ' ' ||
+                               fen.back() == '\r' || fen.back() == '\n'))
+            fen.remove_suffix(1);
+        while(!fen.empty() && fen.front() == ' ') fen.remove_prefix(1);
+        if(fen.size() < 2 || (fen[0] != 'W' && fen[0] != 'B') ||
+           fen[1] != ':')
+            return false;
+        b.setCurrentPlayer(fen[0] == 'W'? 'w': 'b');
+        b.setPieces<White, Pawn>(0).setPieces<White, King>(0)
+         .setPieces<Black, Pawn>(0).setPieces<Black, King>(0);
+        fen.remove_prefix(2);
+        uint64_t seen = 0;
+        while(!fen.empty()) {
+            const size_t colon = fen.find(':');
+            if(!readPieces(fen.substr(0, colon), b, seen)) return false;
+            if(colon == std::string_view::npos) break;
+            fen.remove_prefix(colon + 1);
+        }
+        return true;
+    }
+
+    std::string toFen(const Board& b) {
+        std::string out;
+        out.reserve(96);
+        out.push_back(b.currentPlayer() == White? 'W': 'B');
+        writePieces(out, b, White);
+        writePieces(out, b, Black);
+        return out;
+    }
+
+    int parseMove(std::string_view text, const Board& b, Move* moves) {
+        while(!text.empty() && (text.back() == ' ' ||
+                                text.back() == '\r' || text.back() == '\n'))
+            text.remove_suffix(1);
+        while(!text.empty() && text.front() == ' ') text.remove_prefix(1);
+        int squares[MaxMoveSteps + 1];
+        int n = 0;
+        while(n <= MaxMoveSteps) {
+            const int number = readNumber(text);
+            if(!number) return 0;
+            squares[n++] = numberToSquare(number);
+            if(text.empty()) break;
+            if(text.front() != '-' && text.front() != 'x') return 0;
+            text.remove_prefix(1);
+        }
+        if(n < 2 || !text.empty()) return 0;
+        Board c = b;
+        return matchSteps(c, squares, n, 1, moves, 0);
+    }
+
+    std::string toMoveText(const Move* const moves, const int n) {
+        std::string out;
+        if(n <= 0) return out;
+        out.append(std::to_string(squareToNumber(moves[0].origin())));
+        for(int i = 0; i < n; ++i) {
+            const int d = rankOf(moves[i].origin()) -
+                          rankOf(moves[i].destination());
+            out.push_back(d == 2 || d == -2? 'x': '-');
+            out.append(std::to_string(
+                    squareToNumber(moves[i].destination())));
+        }
+        return out;
+    }
+
+    int parseResult(const std::string_view text) {
+        if(text == "1-0" || text == "2-0") return 2;
+        if(text == "0-1" || text == "0-2") return 0;
+        if(text == "1/2-1/2" || text == "1-1") return 1;
+        if(text == "*") return UnknownResult;
+        return NoResult;
+    }
+
+    bool unpackPosition(const PackedPosition& p, Board::Builder& b) {
+        if((p.white & p.black) || (p.kings & ~(p.white | p.black)) ||
+           p.player > Black)
+            return false;
+        b.setCurrentPlayer(p.player == White? 'w': 'b');
+        b.setPieces<White, Pawn>(0).setPieces<White, King>(0)
+         .setPieces<Black, Pawn>(0).setPieces<Black, King>(0);
+        for(int n = 1; n <= 32; ++n) {
+            const uint32_t bit = 1U << (n - 1);
+            if(!((p.white | p.black) & bit)) continue;
+            b.setPiece(p.white & bit? White: Black,
+                       p.kings & bit? King: Pawn, numberToSquare(n));
+        }
+        return true;
+    }
+
+    PackedPosition packPosition(const Board& b) {
+        PackedPosition p {};
+        p.player = b.currentPlayer();
+        for(const Alliance a: { White, Black })
+            for(uint64_t x = b.getPieces(a, NullPT); x; x &= x - 1) {
+                const int sq = bitScanFwd(x);
+                const uint32_t bit = 1U << (squareToNumber(sq) - 1);
+                (a == White? p.white: p.black) |= bit;
+                if(b.getPiece(sq) == King) p.kings |= bit;
+            }
+        return p;
+    }
+}
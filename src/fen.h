@@ -0,0 +1,128 @@
+#ifndef BITCHECKERS_FEN_H
+#define BITCHECKERS_FEN_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "board.h"
+
+namespace checkers {
+
+    /**
+     * A method to read a position in FEN, as used by PDN,
+     * into a builder. The position names the player to move
+     * and lists the squares of each player's pieces in
+     * standard notation, kings prefixed with 'K', such as
+     * "W:W21,22,K30:B1-12". Ranges of squares are allowed.
+     *
+     * @param fen the position to read
+     * @param b the builder to fill, whose pieces are replaced
+     * @return whether or not the position could be read; if
+     * not, the builder is left in an unspecified state
+     */
+    bool parseFen(std::string_view fen, Board::Builder& b);
+
+    /**
+     * A method to write a position in FEN, as used by PDN.
+     *
+     * @param b the board to write
+     * @return the position, such as "W:W21,22,K30:B1,2"
+     */
+    std::string toFen(const Board& b);
+
+    /**
+     * The most steps of a move: a jump of every piece of the
+     * opponent.
+     */
+    constexpr int MaxMoveSteps = 12;
+
+    /**
+     * A method to read a move in standard notation, such as
+     * "11-15" or "9x18x27", as the moves of the given board
+     * that make it up, one for each jump. The landing squares
+     * of a jump may be left out, as in "9x27", in which case
+     * the first sequence that fits is taken.
+     *
+     * @param text the move to read
+     * @param b the board to move from
+     * @param moves the moves to fill, at least MaxMoveSteps
+     * @return the number of moves filled, or zero if the text
+     * names no legal move
+     */
+    int parseMove(std::string_view text, const Board& b, Move* moves);
+
+    /**
+     * A method to write a move in standard notation.
+     *
+     * @param moves the moves that make up the move, one for
+     * each jump
+     * @param n the number of moves
+     * @return the move, such as "9x18x27"
+     */
+    std::string toMoveText(const Move* moves, int n);
+
+    /** The result of a game that is unfinished, "*". */
+    constexpr int UnknownResult = -1;
+
+    /** The result of a token that is not a result. */
+    constexpr int NoResult = -2;
+
+    /**
+     * A method to read the result of a game as written in
+     * PDN: "1-0", "0-1" or "1/2-1/2", or with two points to a
+     * win, "2-0", "0-2" or "1-1", or "*" for a game that did
+     * not end.
+     *
+     * @param text the result to read
+     * @return the first number of the result in half points,
+     * UnknownResult for "*", or NoResult if the text is not a
+     * result
+     */
+    int parseResult(std::string_view text);
+
+    /**
+     * <summary>
+     * A position packed into 16 bytes, for files of many
+     * positions. Bit n - 1 of each set stands for square n in
+     * standard notation. All is little-endian.
+     * </summary>
+     *
+     * @struct PackedPosition
+     */
+    struct PackedPosition final {
+
+        /** The squares of White's and Black's pieces. */
+        uint32_t white, black;
+
+        /** The squares of the kings of either player. */
+        uint32_t kings;
+
+        /** The player to move, 0 for White and 1 for Black. */
+        uint8_t player;
+
+        /** Zero. */
+        uint8_t reserved[3];
+    };
+
+    static_assert(sizeof(PackedPosition) == 16);
+
+    /**
+     * A method to read a packed position into a builder.
+     *
+     * @param p the position to read
+     * @param b the builder to fill, whose pieces are replaced
+     * @return whether or not the position is valid; if not,
+     * the builder is left in an unspecified state
+     */
+    bool unpackPosition(const PackedPosition& p, Board::Builder& b);
+
+    /**
+     * A method to pack a position.
+     *
+     * @param b the board to pack
+     * @return the packed position
+     */
+    PackedPosition packPosition(const Board& b);
+}
+
+#endif //BITCHECKERS_FEN_H
@@ -0,0 +1,195 @@
+#ifndef BITCHECKERS_HISTORY_H
+#define BITCHECKERS_HISTORY_H
+
+#include <cstring>
+#include "utility.h"
+#include "move.h"
+
+namespace checkers::opponent {
+    using namespace utility;
+
+    /** The maximum search ply. */
+    constexpr int MaxPly = 128;
+
+    /**
+     * <summary>
+     *  <p>
+     * A set of move ordering tables for a single search
+     * thread. Killer moves are kept per ply, while the
+     * butterfly history and counter-move tables are indexed
+     * by the side to move and the 64x64 origin/destination
+     * index of a move (see Move::fromTo).
+     *  </p>
+     *  <p>
+     * These tables are only consulted for quiet (non-jump)
+     * moves. Jumps are forced in checkers, so a position
+     * either has only jumps or only quiet moves.
+     *  </p>
+     * </summary>
+     *
+     * @class History
+     */
+    class History final {
+    public:
+
+        /** The bound on the magnitude of a history score. */
+        static constexpr int MaxHistory = 1 << 14;
+
+        /** The score given to the first killer move. */
+        static constexpr int FirstKillerScore  = 4 * MaxHistory;
+
+        /** The score given to the second killer move. */
+        static constexpr int SecondKillerScore = 3 * MaxHistory;
+
+        /** The score given to the counter move. */
+        static constexpr int CounterScore      = 2 * MaxHistory;
+
+    private:
+
+        /**
+         * @private
+         * Two killer slots per ply.
+         */
+        Move killers[MaxPly][2];
+
+        /**
+         * @private
+         * Butterfly history, indexed by side to move and
+         * origin/destination.
+         */
+        int32_t butterfly[2][BoardLength * BoardLength];
+
+        /**
+         * @private
+         * Counter moves, indexed by side to move and the
+         * origin/destination of the previous move.
+         */
+        Move counters[2][BoardLength * BoardLength];
+
+        /**
+         * @private
+         * A method to apply a bonus to a history entry, with
+         * a gravity term that keeps the entry within
+         * [-MaxHistory, MaxHistory].
+         *
+         * @param entry the entry to update
+         * @param bonus the (possibly negative) bonus
+         */
+        static constexpr void gravity(int32_t& entry, const int bonus) {
+            entry += bonus - entry * abs(bonus) / MaxHistory;
+        }
+
+    public:
+
+        /**
+         * A default constructor for History, which starts
+         * with empty tables.
+         */
+        History() { clear(); }
+
+        /**
+         * A method to empty all tables.
+         */
+        void clear() {
+            std::memset(killers, 0, sizeof(killers));
+            std::memset(butterfly, 0, sizeof(butterfly));
+            std::memset(counters, 0, sizeof(counters));
+        }
+
+        /**
+         * A method to prepare the tables for a new search.
+         * Killers are cleared, as they are only relevant to
+         * the previous tree, while history is halved so that
+         * it may still guide the next search.
+         */
+        void age() {
+            std::memset(killers, 0, sizeof(killers));
+            for(auto& side: butterfly)
+                for(int32_t& h: side) h /= 2;
+        }
+
+        /**
+         * A method to expose a killer move.
+         *
+         * @param ply the ply of the killer move
+         * @param slot the slot of the killer move (0 or 1)
+         * @return the killer move
+         */
+        [[nodiscard]]
+        constexpr Move killer(const int ply, const int slot) const
+        { return killers[ply][slot]; }
+
+        /**
+         * A method to expose the counter move to the given
+         * previous move.
+         *
+         * @param a the side to move
+         * @param prev the previous move
+         * @return the counter move, or the null move
+         */
+        [[nodiscard]]
+        constexpr Move counter(const Alliance a, const Move prev) const
+        { return counters[a][prev.fromTo()]; }
+
+        /**
+         * A method to expose the butterfly history of a move.
+         *
+         * @param a the side to move
+         * @param m the move
+         * @return the history score of the given move
+         */
+        [[nodiscard]]
+        constexpr int history(const Alliance a, const Move m) const
+        { return butterfly[a][m.fromTo()]; }
+
+        /**
+         * A method to score a quiet move for ordering.
+         *
+         * @param a the side to move
+         * @param ply the current ply
+         * @param prev the previous move
+         * @param m the move to score
+         * @return the ordering score of the given move
+         */
+        [[nodiscard]]
+        constexpr int
+        score(const Alliance a, const int ply,
+              const Move prev, const Move m) const {
+            if(m == killers[ply][0]) return FirstKillerScore;
+            if(m == killers[ply][1]) return SecondKillerScore;
+            if(m == counters[a][prev.fromTo()]) return CounterScore;
+            return butterfly[a][m.fromTo()];
+        }
+
+        /**
+         * A method to update the tables after a quiet move
+         * causes a beta cutoff. The quiet moves searched
+         * before the cutoff move are penalized.
+         *
+         * @param a the side to move
+         * @param ply the current ply
+         * @param prev the previous move
+         * @param best the move that caused the cutoff
+         * @param depth the remaining depth
+         * @param quiets the quiet moves that failed low
+         * @param n the number of quiet moves that failed low
+         */
+        void update(const Alliance a, const int ply,
+                    const Move prev, const Move best,
+                    const int depth, const Move* const quiets,
+                    const int n) {
+            const int bonus = depth * depth > 400? 400: depth * depth;
+            if(killers[ply][0] != best) {
+                killers[ply][1] = killers[ply][0];
+                killers[ply][0] = best;
+            }
+            if(prev != NullMove)
+                counters[a][prev.fromTo()] = best;
+            gravity(butterfly[a][best.fromTo()], bonus * 32);
+            for(int i = 0; i < n; ++i)
+                gravity(butterfly[a][quiets[i].fromTo()], -bonus * 32);
+        }
+    };
+}
+
+#endif //BITCHECKERS_HISTORY_H
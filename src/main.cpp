@@ -1,16 +1,41 @@
 #include <iostream>
-#include "board.h"
-#include "move.h"
-#include "movegen.h"
+#include <string>
+#include "protocol.h"
+#include "egdbcache.h"
+#include "book.h"
 
 using namespace checkers;
 
-int main() {
-    State s;
-    Board b = Board::Builder(s).build();
-    Move m[256];
-    Move* u = movegen::generate<All>(m, &b);
-    for(Move* x = m; x < u; ++x)
-        std::cout << *x << '\n';
-    std::cout << b;
+/*
+ * usage: bit [weights] [endgame dir] [book]
+ *
+ * Any argument may be "-" to leave it out. The engine then
+ * takes commands on the standard input until "quit".
+ */
+int main(int argc, char** argv) {
+    const auto given = [&](const int i)
+    { return argc > i && std::string(argv[i]) != "-"; };
+    opponent::Network network;
+    opponent::Patterns patterns;
+    egdb::Database database;
+    egdb::BlockCache blockCache(16);
+    book::Book openingBook;
+    opponent::Engine engine(std::cout);
+    if(given(1)) {
+        if(network.load(argv[1])) engine.setEvaluation(&network, nullptr);
+        else if(patterns.load(argv[1]))
+            engine.setEvaluation(nullptr, &patterns);
+        else std::cerr << "Cannot load weights " << argv[1] << '\n';
+    }
+    if(given(2)) {
+        if(database.open(argv[2], 8)) {
+            database.setCache(&blockCache);
+            engine.setEndgameDatabase(&database);
+        } else std::cerr << "Cannot open endgame database " << argv[2] << '\n';
+    }
+    if(given(3)) {
+        if(openingBook.open(argv[3])) engine.setBook(&openingBook);
+        else std::cerr << "Cannot open book " << argv[3] << '\n';
+    }
+    engine.loop(std::cin);
 }
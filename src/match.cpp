@@ -0,0 +1,472 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "board.h"
+#include "fen.h"
+#include "movegen.h"
+#include "opponent.h"
+#include "protocol.h"
+
+using namespace checkers;
+using namespace checkers::opponent;
+
+/*
+ * A match runner, which plays two configurations of the
+ * engine against each other in game pairs, one per thread at
+ * a time, each opening played once with either configuration
+ * moving first. A sequential probability ratio test on the
+ * pair results ends the match as soon as the first
+ * configuration is shown to be elo1 Elo stronger than the
+ * second (H1) or no more than elo0 (H0).
+ *
+ * usage: match <openings> <first> <second> [pairs] [threads]
+ *              [--elo0 e] [--elo1 e] [--alpha a] [--beta b]
+ *
+ * Each configuration is a list of settings separated by
+ * commas, such as "nodes=20000" or
+ * "time=10000,inc=100,weights=net.bin,probcut=0":
+ *
+ *   weights=file         network or pattern weights
+ *   depth=n, nodes=n     the limits of each search
+ *   movetime=ms          the time of each search
+ *   time=ms, inc=ms      a clock for the game, lost when it
+ *                        runs out, and its increment
+ *   hash=mb              the transposition table of each game
+ *   lmr=0, futility=0,   search features to turn off
+ *   probcut=0, bitbase=0
+ *
+ * Each line of the openings file holds an optional FEN of the
+ * position it starts from, the engine's start position if
+ * there is none, and moves in standard notation, the
+ * openings being taken in turn. A game is drawn on a third
+ * repetition, after MaxQuietTurns turns in a row with neither
+ * a jump nor a pawn move, or after MaxGameTurns turns.
+ */
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /** The most turns of a game before it is drawn. */
+    constexpr int MaxGameTurns = 300;
+
+    /**
+     * The most turns in a row of king moves without a jump
+     * before a game is drawn.
+     */
+    constexpr int MaxQuietTurns = 80;
+
+    /** The number of game pairs by default. */
+    constexpr long DefaultPairs = 1000;
+
+    /** The size of each transposition table by default. */
+    constexpr size_t DefaultTableMegabytes = 16;
+
+    /** The size of each evaluation cache. */
+    constexpr size_t EvalCacheMegabytes = 1;
+
+    /** The number of pairs between reports. */
+    constexpr long ReportInterval = 50;
+
+    /**
+     * <summary>
+     * A configuration of the engine.
+     * </summary>
+     *
+     * @struct Player
+     */
+    struct Player final {
+        std::string name;
+        std::unique_ptr<Network> network = std::make_unique<Network>();
+        std::unique_ptr<Patterns> patterns = std::make_unique<Patterns>();
+        SearchOptions options;
+        SearchLimits limits;
+        int64_t time = 0, increment = 0;
+        size_t tableMegabytes = DefaultTableMegabytes;
+    };
+
+    /**
+     * <summary>
+     * An opening, as the position it starts from and the
+     * steps of its moves.
+     * </summary>
+     *
+     * @struct Opening
+     */
+    struct Opening final {
+        std::string fen;
+        std::vector<Move> steps;
+    };
+
+    /**
+     * <summary>
+     * A configuration ready to play on one thread, with its
+     * own tables and search.
+     * </summary>
+     *
+     * @struct Seat
+     */
+    struct Seat final {
+        const Player& player;
+        TranspositionTable tt;
+        EvalCache evalCache;
+        Search search;
+
+        Seat(const Player& p, const Board& root) :
+                player(p),
+                tt(p.tableMegabytes),
+                evalCache(EvalCacheMegabytes),
+                search(root, tt) {
+            search.setOptions(p.options);
+            search.setEvalCache(&evalCache);
+            if(p.network->loaded()) search.setNetwork(p.network.get());
+            else if(p.patterns->loaded())
+                search.setPatterns(p.patterns.get());
+        }
+    };
+
+    /**
+     * A method to read a configuration.
+     *
+     * @param text the settings, separated by commas
+     * @param p the configuration to fill
+     * @return whether or not every setting could be read
+     */
+    bool readPlayer(const std::string& text, Player& p) {
+        p.name = text;
+        std::istringstream in(text);
+        for(std::string setting; std::getline(in, setting, ',');) {
+            const size_t equals = setting.find('=');
+            if(equals == std::string::npos) return false;
+            const std::string key = setting.substr(0, equals);
+            const std::string value = setting.substr(equals + 1);
+            const long long n = std::atoll(value.c_str());
+            if(key == "weights") {
+                if(!p.network->load(value.c_str()) &&
+                   !p.patterns->load(value.c_str()))
+                    return false;
+            } else if(key == "depth") p.limits.depth = (int) n;
+            else if(key == "nodes") p.limits.nodes = (uint64_t) n;
+            else if(key == "movetime") p.limits.moveTime = n;
+            else if(key == "time") p.time = n;
+            else if(key == "inc") p.increment = n;
+            else if(key == "hash") p.tableMegabytes = std::max(1LL, n);
+            else if(key == "lmr") p.options.lateMoveReductions = n;
+            else if(key == "futility") p.options.futilityPruning = n;
+            else if(key == "probcut") p.options.probCut = n;
+            else if(key == "bitbase") p.options.bitbase = n;
+            else return false;
+        }
+        // A search must have some limit short of its full depth.
+        return p.limits.depth > 0 && (p.limits.depth < MaxDepth ||
+               p.limits.nodes || p.limits.moveTime || p.time);
+    }
+
+    /**
+     * A method to read the openings.
+     *
+     * @param path the path of the openings file
+     * @param openings the openings to fill
+     * @return the number of lines that could not be read
+     */
+    long readOpenings(const char* path, std::vector<Opening>& openings) {
+        std::ifstream in(path);
+        long skipped = 0;
+        for(std::string line; std::getline(in, line);) {
+            std::istringstream tokens(line);
+            std::string token;
+            if(!(tokens >> token)) continue;
+            Opening o;
+            std::vector<State> states(1);
+            states.reserve(MaxGameTurns * MaxMoveSteps);
+            Board::Builder builder(states[0]);
+            bool legal = true;
+            if(token.find(':') != std::string::npos) {
+                legal = parseFen(token, builder);
+                o.fen = token;
+                if(!(tokens >> token)) token.clear();
+            }
+            if(!legal) {
+                ++skipped;
+                continue;
+            }
+            Board b = builder.build();
+            for(; legal && !token.empty(); token.clear(), tokens >> token) {
+                if(token.back() == '.') continue;
+                Move steps[MaxMoveSteps];
+                const int n = parseMove(token, b, steps);
+                legal = n > 0 && states.size() + n <= states.capacity();
+                for(int i = 0; legal && i < n; ++i) {
+                    b.applyMove(steps[i], states.emplace_back());
+                    o.steps.push_back(steps[i]);
+                }
+            }
+            if(legal) openings.push_back(std::move(o));
+            else ++skipped;
+        }
+        return skipped;
+    }
+
+    /**
+     * A method to play a game.
+     *
+     * @param seats the configurations, the first moving first
+     * @param o the opening
+     * @return the points of the first configuration in half
+     * points: 2 for a win, 1 for a draw and 0 for a loss
+     */
+    int playGame(Seat* const seats[2], const Opening& o) {
+        std::vector<State> states(MaxGameTurns * MaxMoveSteps +
+                                  o.steps.size() + 1);
+        Board::Builder builder(states[0]);
+        if(!o.fen.empty()) parseFen(o.fen, builder);
+        Board b = builder.build();
+        size_t used = 1;
+        for(const Move m: o.steps) b.applyMove(m, states[used++]);
+
+        const Alliance first = b.currentPlayer();
+        int64_t clocks[2] = { seats[0]->player.time,
+                              seats[1]->player.time };
+        std::unordered_map<uint64_t, int> seen;
+        for(Seat* const s: { seats[0], seats[1] }) {
+            s->tt.clear();
+            s->evalCache.clear();
+        }
+        for(int turn = 0, quiet = 0; turn < MaxGameTurns &&
+                                     quiet < MaxQuietTurns; ++turn) {
+            const int mover = b.currentPlayer() == first? 0: 1;
+            Seat& seat = *seats[mover];
+            Move legal[movegen::MaxMoves];
+            if(movegen::generate<All>(legal, &b) == legal)
+                return mover? 2: 0;
+            if(++seen[b.getKey()] == 3) return 1;
+
+            SearchLimits l = seat.player.limits;
+            if(seat.player.time) {
+                const Alliance us = b.currentPlayer();
+                l.time[us] = clocks[mover];
+                l.time[~us] = clocks[1 - mover];
+                l.increment[us] = seat.player.increment;
+                l.increment[~us] = seats[1 - mover]->player.increment;
+            }
+            const Clock::time_point start = Clock::now();
+            seat.tt.newSearch();
+            seat.search.setBoard(b);
+            seat.search.clearSignals();
+            const Move best = seat.search.think(l);
+            if(best == NullMove) return mover? 2: 0;
+            Move steps[MaxMoveSteps];
+            const int n = completeMove(seat.search, b, best,
+                                       seat.search.line(0), steps);
+            if(seat.player.time) {
+                clocks[mover] -= std::chrono::duration_cast
+                        <std::chrono::milliseconds>
+                        (Clock::now() - start).count();
+                if(clocks[mover] < 0) return mover? 2: 0;
+                clocks[mover] += seat.player.increment;
+            }
+
+            bool irreversible = false;
+            for(int i = 0; i < n; ++i) {
+                const int d = rankOf(steps[i].origin()) -
+                              rankOf(steps[i].destination());
+                irreversible = irreversible || d == 2 || d == -2 ||
+                               b.getPiece(steps[i].origin()) == Pawn;
+                b.applyMove(steps[i], states[used++]);
+            }
+            if(irreversible) {
+                quiet = 0;
+                seen.clear();
+            } else ++quiet;
+        }
+        return 1;
+    }
+
+    /**
+     * <summary>
+     * The results of the pairs played so far, by the half
+     * points the first configuration scored in each, 0 to 4.
+     * </summary>
+     *
+     * @struct Tally
+     */
+    struct Tally final {
+        long pairs[5] = { 0, 0, 0, 0, 0 };
+        long wins = 0, draws = 0, losses = 0;
+
+        long count() const
+        { return pairs[0] + pairs[1] + pairs[2] + pairs[3] + pairs[4]; }
+
+        /**
+         * A method to find the mean score of a pair and its
+         * variance, as fractions of the pair's two points.
+         *
+         * @param mean the mean to fill
+         * @param variance the variance to fill
+         */
+        void moments(double& mean, double& variance) const {
+            const double n = (double) count();
+            mean = variance = 0;
+            for(int i = 0; i < 5; ++i) mean += pairs[i] * (i / 4.0);
+            mean /= n;
+            for(int i = 0; i < 5; ++i)
+                variance += pairs[i] * (i / 4.0 - mean) * (i / 4.0 - mean);
+            variance /= n;
+        }
+
+        /**
+         * A method to find the log-likelihood ratio of H1
+         * against H0 by the normal approximation of the
+         * generalized SPRT.
+         *
+         * @param elo0 the Elo difference of H0
+         * @param elo1 the Elo difference of H1
+         * @return the log-likelihood ratio
+         */
+        double llr(const double elo0, const double elo1) const {
+            double mean, variance;
+            moments(mean, variance);
+            if(variance <= 0) return 0;
+            const auto score = [](const double elo)
+            { return 1 / (1 + std::pow(10.0, -elo / 400)); };
+            const double s0 = score(elo0), s1 = score(elo1);
+            return (double) count() * (s1 - s0) *
+                   (2 * mean - s0 - s1) / (2 * variance);
+        }
+
+        /**
+         * A method to estimate the Elo difference and the
+         * half-width of its 95% interval.
+         *
+         * @param difference the difference to fill
+         * @param margin the half-width to fill
+         */
+        void elo(double& difference, double& margin) const {
+            double mean, variance;
+            moments(mean, variance);
+            const auto toElo = [](const double s) {
+                const double c = std::clamp(s, 1e-6, 1 - 1e-6);
+                return -400 * std::log10(1 / c - 1);
+            };
+            const double e = 1.96 * std::sqrt(variance / (double) count());
+            difference = toElo(mean);
+            margin = (toElo(mean + e) - toElo(mean - e)) / 2;
+        }
+    };
+}
+
+int main(int argc, char** argv) {
+    if(argc < 4) {
+        std::cerr << "usage: " << argv[0] << " <openings> <first> <second>"
+                     " [pairs] [threads] [--elo0 e] [--elo1 e]"
+                     " [--alpha a] [--beta b]\n";
+        return 1;
+    }
+    Player players[2];
+    for(int i = 0; i < 2; ++i)
+        if(!readPlayer(argv[2 + i], players[i])) {
+            std::cerr << "Cannot read configuration " << argv[2 + i] << '\n';
+            return 1;
+        }
+    long pairs = DefaultPairs;
+    int threads = (int) std::max(1U, std::thread::hardware_concurrency());
+    double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+    for(int i = 4, positional = 0; i < argc; ++i) {
+        const bool valued = i + 1 < argc;
+        if(!std::strcmp(argv[i], "--elo0") && valued)
+            elo0 = std::atof(argv[++i]);
+        else if(!std::strcmp(argv[i], "--elo1") && valued)
+            elo1 = std::atof(argv[++i]);
+        else if(!std::strcmp(argv[i], "--alpha") && valued)
+            alpha = std::atof(argv[++i]);
+        else if(!std::strcmp(argv[i], "--beta") && valued)
+            beta = std::atof(argv[++i]);
+        else if(positional == 0 && std::atol(argv[i]) > 0) {
+            pairs = std::atol(argv[i]);
+            ++positional;
+        } else if(positional == 1 && std::atoi(argv[i]) > 0) {
+            threads = std::atoi(argv[i]);
+            ++positional;
+        } else {
+            std::cerr << "Unknown argument " << argv[i] << '\n';
+            return 1;
+        }
+    }
+    if(alpha <= 0 || alpha >= 1 || beta <= 0 || beta >= 1 || elo1 <= elo0) {
+        std::cerr << "Need 0 < alpha, beta < 1 and elo0 < elo1\n";
+        return 1;
+    }
+    const double lower = std::log(beta / (1 - alpha));
+    const double upper = std::log((1 - beta) / alpha);
+
+    std::vector<Opening> openings;
+    const long skipped = readOpenings(argv[1], openings);
+    if(openings.empty()) {
+        std::cerr << "No openings in " << argv[1] << '\n';
+        return 1;
+    }
+    std::cout << "openings " << openings.size() << " skipped " << skipped
+              << " llr bounds " << std::fixed << std::setprecision(2)
+              << lower << ' ' << upper << std::endl;
+
+    std::mutex lock;
+    Tally tally;
+    std::atomic<long> next = 0;
+    std::atomic<bool> decided = false;
+    const char* verdict = "inconclusive";
+    const auto report = [&] {
+        double difference, margin;
+        tally.elo(difference, margin);
+        std::cout << "pairs " << tally.count() << " +" << tally.wins
+                  << " -" << tally.losses << " =" << tally.draws
+                  << " elo " << difference << " +- " << margin
+                  << " llr " << tally.llr(elo0, elo1) << std::endl;
+    };
+
+    std::vector<std::thread> pool;
+    for(int t = 0; t < threads; ++t)
+        pool.emplace_back([&] {
+            State s;
+            const Board root = Board::Builder(s).build();
+            Seat first(players[0], root), second(players[1], root);
+            for(long i; !decided.load() && (i = next.fetch_add(1)) < pairs;) {
+                const Opening& o = openings[i % openings.size()];
+                Seat* const order[2][2] = { { &first, &second },
+                                            { &second, &first } };
+                const int a = playGame(order[0], o);
+                const int b = 2 - playGame(order[1], o);
+                std::lock_guard<std::mutex> g(lock);
+                ++tally.pairs[a + b];
+                for(const int points: { a, b }) {
+                    tally.wins += points == 2;
+                    tally.draws += points == 1;
+                    tally.losses += points == 0;
+                }
+                // The pairs already under way when the test ends
+                // are still counted.
+                const double llr = tally.llr(elo0, elo1);
+                if(!decided && (llr <= lower || llr >= upper)) {
+                    verdict = llr >= upper? "H1 accepted": "H0 accepted";
+                    decided = true;
+                }
+                if(tally.count() % ReportInterval == 0) report();
+            }
+        });
+    for(std::thread& th: pool) th.join();
+
+    report();
+    std::cout << players[0].name << " vs " << players[1].name << ": "
+              << verdict << std::endl;
+    return 0;
+}
@@ -4,6 +4,7 @@
 
 #ifndef BITCHECKERS_MOVE_H
 #define BITCHECKERS_MOVE_H
+#include <string>
 #include "utility.h"
 
 namespace checkers {
@@ -138,6 +139,18 @@ namespace checkers {
         constexpr int origin() const
         { return (manifest & From) >> 6U; }
 
+        /**
+         * A method to expose the origin and destination of
+         * this move as a single index, for use with 64x64
+         * butterfly tables.
+         *
+         * @return the origin and destination of this move
+         * (0-4095, decimal)
+         */
+        [[nodiscard]]
+        constexpr int fromTo() const
+        { return manifest & (From | To); }
+
         /**
          * A method to expose the type of this move.
          *
@@ -147,6 +160,20 @@ namespace checkers {
         constexpr MoveType moveType() const
         { return MoveType((manifest & Type) >> 12U); }
 
+        /**
+         * A method to represent this move in standard checkers
+         * notation, such as "11-15" for a quiet move or
+         * "15x24" for a jump.
+         *
+         * @return this move in standard checkers notation
+         */
+        [[nodiscard]]
+        std::string notation() const {
+            return std::to_string(squareToNumber(origin())) +
+                   (moveType() == Aggressive? 'x': '-') +
+                   std::to_string(squareToNumber(destination()));
+        }
+
         /**
          * An operator overload for the equality operator.
          *
@@ -7,6 +7,28 @@
 namespace checkers::movegen {
     namespace {
 
+        /**
+         * A method to add every jump in the given direction
+         * to the given move list.
+         *
+         * @tparam D the direction of the jumps
+         * @param moves the move list to fill
+         * @param jumpers the pieces that may jump
+         * @param enemies the enemy pieces
+         * @param empty the empty squares
+         * @return a pointer to the end of the move list
+         */
+        template<Direction D>
+        Move* makeJumps(Move* moves, const uint64_t jumpers,
+                        const uint64_t enemies, const uint64_t empty) {
+            for(uint64_t t = jumpTargets<D>(jumpers, enemies, empty);
+                t; t &= t - 1) {
+                const int d = bitScanFwd(t);
+                *moves++ = Move::make<Aggressive>(d - 2 * D, d);
+            }
+            return moves;
+        }
+
         template<Alliance A, MoveType MT>
         Move* makeKing(Move* moves, Board* const b) {
 
@@ -17,13 +39,24 @@ namespace checkers::movegen {
             const uint64_t
                 allPieces = b->getAllPieces(),
                 ourPieces = b->getPieces<us, King>(),
-                enemies = b->getPieces<them, King>();
-
-            if(MT != Passive) {
-                // Aggressive king moves here?
+                jumper = b->getJumper();
+
+            if(MT == Aggressive) {
+                const uint64_t
+                    jumpers = jumper? ourPieces & jumper: ourPieces,
+                    enemies = b->getPieces<them>();
+                moves = makeJumps<x->upLeft>
+                        (moves, jumpers, enemies, ~allPieces);
+                moves = makeJumps<x->upRight>
+                        (moves, jumpers, enemies, ~allPieces);
+                moves = makeJumps<x->downLeft>
+                        (moves, jumpers, enemies, ~allPieces);
+                return makeJumps<x->downRight>
+                        (moves, jumpers, enemies, ~allPieces);
             }
 
-            if(MT == Aggressive) return moves;
+            // No quiet moves in the middle of a multi-jump.
+            if(jumper) return moves;
 
             uint64_t oursNotOnRight = ourPieces & x->notRightFile,
                      oursNotOnLeft = ourPieces & x->notLeftFile,
@@ -71,20 +104,22 @@ namespace checkers::movegen {
             const uint64_t
                 allPieces = b->getAllPieces(),
                 ourPieces = b->getPieces<us, Pawn>(),
-                enemies = b->getPieces<them, Pawn>(),
+                jumper = b->getJumper(),
                 ourLowPieces = ourPieces & ~x->promotionMask,
-                ourMidPieces = ourPieces & x->midPromotionMask,
-                ourHighPieces = ourPieces & x->highPromotionMask;
-
-            if(MT != Passive) {
-                // Aggressive "jump" moves here?
-                if(MT != Promotion) {
-                    //Aggressive non-promotion moves here?
-                }
-                // Aggressive promotion moves here?
+                ourMidPieces = ourPieces & x->midPromotionMask;
+
+            if(MT == Aggressive) {
+                const uint64_t
+                    jumpers = jumper? ourPieces & jumper: ourPieces,
+                    enemies = b->getPieces<them>();
+                moves = makeJumps<x->upLeft>
+                        (moves, jumpers, enemies, ~allPieces);
+                return makeJumps<x->upRight>
+                        (moves, jumpers, enemies, ~allPieces);
             }
 
-            if(MT == Aggressive) return moves;
+            // No quiet moves in the middle of a multi-jump.
+            if(jumper) return moves;
 
             if(MT != Promotion) {
 
@@ -109,10 +144,10 @@ namespace checkers::movegen {
             }
 
             uint64_t pr =
-                shift<x->upRight>(ourHighPieces & x->notRightFile)
+                shift<x->upRight>(ourMidPieces & x->notRightFile)
                     & ~allPieces,
                      pl =
-                shift<x->upLeft>(ourHighPieces & x->notLeftFile)
+                shift<x->upLeft>(ourMidPieces & x->notLeftFile)
                     & ~allPieces;
 
             for(int d; pr; pr &= pr - 1) {
@@ -130,14 +165,65 @@ namespace checkers::movegen {
             return moves;
         }
 
+        /**
+         * A method to add every unmove in the given direction
+         * to the given move list.
+         *
+         * @tparam D the direction the pieces moved in
+         * @param moves the move list to fill
+         * @param pieces the pieces that may have moved
+         * @param notEdge the pieces that may not have crossed
+         * the edge of the board moving in the given direction
+         * @param empty the empty squares
+         * @return a pointer to the end of the move list
+         */
+        template<Direction D>
+        Move* makeUnmoves(Move* moves, const uint64_t pieces,
+                          const uint64_t notEdge,
+                          const uint64_t empty) {
+            constexpr Direction Back = Direction(-D);
+            for(uint64_t o = shift<Back>(pieces & notEdge) & empty;
+                o; o &= o - 1) {
+                const int d = bitScanFwd(o);
+                *moves++ = Move::make(d, d + D);
+            }
+            return moves;
+        }
+
+        template<Alliance A>
+        Move* makeAllUnmoves(Move* moves, const Board* const b) {
+            constexpr const Defaults* x = getDefaults<A>();
+            const uint64_t
+                empty = ~b->getAllPieces(),
+                kings = b->getPieces<A, King>(),
+                pawns = b->getPieces<A, Pawn>(),
+                all = kings | pawns;
+            // A piece that moved up came from down, across the
+            // opposite edge of the board.
+            moves = makeUnmoves<x->upLeft>
+                    (moves, all, x->notRightFile, empty);
+            moves = makeUnmoves<x->upRight>
+                    (moves, all, x->notLeftFile, empty);
+            moves = makeUnmoves<x->downLeft>
+                    (moves, kings, x->notRightFile, empty);
+            return makeUnmoves<x->downRight>
+                    (moves, kings, x->notLeftFile, empty);
+        }
+
         template<Alliance A, MoveType MT>
         Move* makeAll(Move* moves, Board* const b) {
-            constexpr const Defaults* x = getDefaults<A>();
-            // stubs.
+            if(MT == All) {
+                // Jumps are compulsory: quiet moves are only
+                // legal when no jump is available.
+                Move* const start = moves;
+                moves = makeKing<A, Aggressive>(moves, b);
+                moves = makePawn<A, Aggressive>(moves, b);
+                if(moves != start) return moves;
+                moves = makeKing<A, Passive>(moves, b);
+                return makePawn<A, Passive>(moves, b);
+            }
             moves = makeKing<A, MT>(moves, b);
-            moves = makePawn<A, MT>(moves, b);
-            // stub.
-            return moves;
+            return makePawn<A, MT>(moves, b);
         }
     }
 
@@ -148,6 +234,13 @@ namespace checkers::movegen {
                 makeAll<Black, MT>(moves, b) ;
     }
 
+    Move* generateUnmoves(Move* const moves, const Board* const b) {
+        assert(!b->getJumper());
+        return b->currentPlayer() == White ?
+                makeAllUnmoves<Black>(moves, b) :
+                makeAllUnmoves<White>(moves, b) ;
+    }
+
     template Move* generate<All>(Move*, Board*);
     template Move* generate<Aggressive>(Move*, Board*);
     template Move* generate<Passive>(Move*, Board*);
@@ -11,8 +11,31 @@
 namespace checkers::movegen {
     using namespace utility;
 
+    /**
+     * The maximum number of moves that may be generated
+     * for a single position.
+     */
+    constexpr int MaxMoves = 128;
+
     template<MoveType MT>
     Move* generate(Move*, Board*);
+
+    /**
+     * A method to generate the quiet moves that the player
+     * who is not to move could have just made to reach the
+     * given board, the reverse of the moves that generate
+     * makes. Promotions are not included, since the piece
+     * before the move was of another type. Whether each move
+     * was legal, with no jump available before it, is left
+     * to the caller.
+     *
+     * @param moves the move list to fill, with moves from
+     * their origin before the move to their destination
+     * @param b the board after the move, with no multi-jump
+     * in progress
+     * @return a pointer to the end of the move list
+     */
+    Move* generateUnmoves(Move* moves, const Board* b);
 }
 
 
@@ -0,0 +1,238 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "nnue.h"
+
+namespace checkers::opponent {
+    namespace {
+
+        /**
+         * A method to compute the index of a feature from the
+         * point of view of the given alliance. Pieces are
+         * relative to the perspective, and Black sees the
+         * board turned around, so that both perspectives share
+         * the same weights.
+         *
+         * @param p the perspective
+         * @param a the alliance of the piece
+         * @param pt the type of the piece
+         * @param sq the square of the piece
+         * @return the index of the feature
+         */
+        constexpr int feature(const Alliance p, const Alliance a,
+                              const PieceType pt, const int sq) {
+            const int rel = a != p, s = p == White? sq: 63 - sq;
+            return ((rel << 1) + pt) * 32 + (s >> 1);
+        }
+
+        /**
+         * A method to clip a value to the range of the
+         * activations, [0, 127].
+         *
+         * @param x the value to clip
+         * @return the clipped value
+         */
+        constexpr int clip(const int x)
+        { return x < 0? 0: x > 127? 127: x; }
+
+#if defined(__AVX2__)
+        /**
+         * A method to sum the eight 32-bit lanes of a vector.
+         *
+         * @param v the vector to sum
+         * @return the sum of its lanes
+         */
+        inline int horizontalSum(const __m256i v) {
+            __m128i x = _mm_add_epi32(_mm256_castsi256_si128(v),
+                                      _mm256_extracti128_si256(v, 1));
+            x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0x4E));
+            x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0xB1));
+            return _mm_cvtsi128_si32(x);
+        }
+#endif
+    }
+
+    Network::Network() :
+            mapping(nullptr),
+            featureWeights(nullptr),
+            featureBiases(nullptr),
+            hiddenWeights(nullptr),
+            hiddenBiases(nullptr),
+            outputWeights(nullptr),
+            outputBias(nullptr)
+    {  }
+
+    Network::~Network()
+    { unload(); }
+
+    void Network::unload() {
+        if(mapping) munmap(mapping, FileSize);
+        mapping = nullptr;
+    }
+
+    bool Network::load(const char* const path) {
+        unload();
+        const int fd = open(path, O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st{};
+        void* const m = fstat(fd, &st) == 0 &&
+                        (size_t) st.st_size == FileSize?
+                mmap(nullptr, FileSize, PROT_READ, MAP_PRIVATE, fd, 0):
+                MAP_FAILED;
+        close(fd);
+        if(m == MAP_FAILED) return false;
+        const auto* const h = (const NnueHeader*) m;
+        if(h->magic != Magic || h->version != Version ||
+           h->inputs != NnueInputs || h->l1 != NnueL1 ||
+           h->l2 != NnueL2) {
+            munmap(m, FileSize);
+            return false;
+        }
+        const auto* p = (const char*) m + sizeof(NnueHeader);
+        featureWeights = (const int16_t*) p;
+        p += sizeof(int16_t) * NnueInputs * NnueL1;
+        featureBiases = (const int16_t*) p;
+        p += sizeof(int16_t) * NnueL1;
+        hiddenWeights = (const int8_t*) p;
+        p += sizeof(int8_t) * NnueL2 * 2 * NnueL1;
+        hiddenBiases = (const int32_t*) p;
+        p += sizeof(int32_t) * NnueL2;
+        outputWeights = (const int8_t*) p;
+        p += sizeof(int8_t) * NnueL2;
+        outputBias = (const int32_t*) p;
+        mapping = m;
+        return true;
+    }
+
+    template<bool Add, bool Simd>
+    void Network::toggle(Accumulator& acc, const Alliance a,
+                         const PieceType pt, const int sq) const {
+        for(const Alliance p: { White, Black }) {
+            const int16_t* const w =
+                    featureWeights + feature(p, a, pt, sq) * NnueL1;
+            int16_t* const v = acc.values[p];
+            if constexpr(Simd) {
+#if defined(__AVX2__)
+                for(int i = 0; i < NnueL1; i += 16) {
+                    const __m256i x = _mm256_load_si256((__m256i*) (v + i));
+                    const __m256i y =
+                            _mm256_loadu_si256((const __m256i*) (w + i));
+                    _mm256_store_si256((__m256i*) (v + i), Add?
+                            _mm256_add_epi16(x, y): _mm256_sub_epi16(x, y));
+                }
+#endif
+            } else {
+                for(int i = 0; i < NnueL1; ++i)
+                    v[i] = (int16_t) (Add? v[i] + w[i]: v[i] - w[i]);
+            }
+        }
+    }
+
+    template<bool Simd>
+    void Network::refresh(const Board& b, Accumulator& acc) const {
+        for(int16_t* const v: acc.values)
+            for(int i = 0; i < NnueL1; ++i) v[i] = featureBiases[i];
+        for(const Alliance a: { White, Black })
+            for(const PieceType pt: { Pawn, King })
+                for(uint64_t x = b.getPieces(a, pt); x; x &= x - 1)
+                    toggle<true, Simd>(acc, a, pt, bitScanFwd(x));
+    }
+
+    template<bool Simd>
+    void Network::update(const Board& b, const Move m,
+                         const Accumulator& before,
+                         Accumulator& after) const {
+        // The turn passes unless a multi-jump goes on.
+        const Alliance us = b.getJumper()?
+                b.currentPlayer(): ~b.currentPlayer();
+        const State* const s = b.getState();
+        const int from = m.origin(), to = m.destination();
+        const PieceType pt = b.getPiece(to);
+        after = before;
+        toggle<false, Simd>(after, us, s->isPromotion()? Pawn: pt, from);
+        toggle<true, Simd>(after, us, pt, to);
+        if(s->capturedPieceType() != NullPT)
+            toggle<false, Simd>(after, ~us, s->capturedPieceType(),
+                                (from + to) >> 1U);
+    }
+
+    template<bool Simd>
+    int Network::evaluate(const Accumulator& acc,
+                          const Alliance us) const {
+        alignas(32) uint8_t input[2 * NnueL1];
+        alignas(32) int hidden[NnueL2];
+        const Alliance perspectives[] = { us, ~us };
+        if constexpr(Simd) {
+#if defined(__AVX2__)
+            const __m256i zero = _mm256_setzero_si256();
+            for(int h = 0; h < 2; ++h) {
+                const int16_t* const v = acc.values[perspectives[h]];
+                for(int i = 0; i < NnueL1; i += 32) {
+                    const __m256i x = _mm256_load_si256((__m256i*) (v + i));
+                    const __m256i y =
+                            _mm256_load_si256((__m256i*) (v + i + 16));
+                    // Packing interleaves the 128-bit lanes; the
+                    // permutation puts them back in order.
+                    const __m256i c = _mm256_permute4x64_epi64(
+                            _mm256_max_epi8(_mm256_packs_epi16(x, y), zero),
+                            0xD8);
+                    _mm256_store_si256(
+                            (__m256i*) (input + h * NnueL1 + i), c);
+                }
+            }
+            const __m256i ones = _mm256_set1_epi16(1);
+            for(int j = 0; j < NnueL2; ++j) {
+                const int8_t* const w = hiddenWeights + j * 2 * NnueL1;
+                __m256i sum = zero;
+                for(int i = 0; i < 2 * NnueL1; i += 32) {
+                    const __m256i x = _mm256_load_si256((__m256i*) (input + i));
+                    const __m256i y =
+                            _mm256_loadu_si256((const __m256i*) (w + i));
+                    // A pair of products never exceeds 2 * 127 * 127,
+                    // so the 16-bit sums never saturate.
+                    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(
+                            _mm256_maddubs_epi16(x, y), ones));
+                }
+                hidden[j] = clip((hiddenBiases[j] + horizontalSum(sum))
+                                 >> WeightShift);
+            }
+#endif
+        } else {
+            for(int h = 0; h < 2; ++h) {
+                const int16_t* const v = acc.values[perspectives[h]];
+                for(int i = 0; i < NnueL1; ++i)
+                    input[h * NnueL1 + i] = (uint8_t) clip(v[i]);
+            }
+            for(int j = 0; j < NnueL2; ++j) {
+                const int8_t* const w = hiddenWeights + j * 2 * NnueL1;
+                int sum = hiddenBiases[j];
+                for(int i = 0; i < 2 * NnueL1; ++i)
+                    sum += input[i] * w[i];
+                hidden[j] = clip(sum >> WeightShift);
+            }
+        }
+        int out = *outputBias;
+        for(int j = 0; j < NnueL2; ++j)
+            out += hidden[j] * outputWeights[j];
+        return out / OutputDivisor;
+    }
+
+    template void Network::refresh<false>(const Board&, Accumulator&) const;
+    template void Network::update<false>(const Board&, Move,
+                                         const Accumulator&,
+                                         Accumulator&) const;
+    template int Network::evaluate<false>(const Accumulator&,
+                                          Alliance) const;
+#if defined(__AVX2__)
+    template void Network::refresh<true>(const Board&, Accumulator&) const;
+    template void Network::update<true>(const Board&, Move,
+                                        const Accumulator&,
+                                        Accumulator&) const;
+    template int Network::evaluate<true>(const Accumulator&,
+                                         Alliance) const;
+#endif
+}
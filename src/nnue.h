@@ -0,0 +1,246 @@
+#ifndef BITCHECKERS_NNUE_H
+#define BITCHECKERS_NNUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "board.h"
+
+namespace checkers::opponent {
+    using namespace utility;
+
+    /**
+     * The number of input features: one for each alliance,
+     * relative to the perspective, each piece type and each
+     * playable square.
+     */
+    constexpr int NnueInputs = 2 * 2 * 32;
+
+    /** The number of accumulator values of each perspective. */
+    constexpr int NnueL1 = 128;
+
+    /** The number of neurons in the hidden layer. */
+    constexpr int NnueL2 = 32;
+
+    /** Whether or not this build has the AVX2 inference path. */
+#if defined(__AVX2__)
+    constexpr bool NnueSimd = true;
+#else
+    constexpr bool NnueSimd = false;
+#endif
+
+    /**
+     * <summary>
+     * The first layer of the network for one position, from
+     * the point of view of each alliance. It is updated as
+     * moves are made rather than recomputed for every
+     * evaluation.
+     * </summary>
+     *
+     * @struct Accumulator
+     */
+    struct alignas(32) Accumulator final {
+        int16_t values[2][NnueL1];
+    };
+
+    /**
+     * <summary>
+     *  <p>
+     * A small efficiently updatable neural network. The first
+     * layer is indexed by alliance, piece type and square, and
+     * is kept in an Accumulator from each alliance's point of
+     * view. The two halves, side to move first, are clipped to
+     * [0, 127] and fed through an int8 hidden layer of NnueL2
+     * neurons and a single int8 output neuron.
+     *  </p>
+     *  <p>
+     * The weights are used in place from a read-only memory
+     * mapping of the network file, so loading does not read
+     * or copy the file. The file holds a NnueHeader followed
+     * by, in order and little-endian:
+     * <ul>
+     *  <li>int16 feature weights [NnueInputs][NnueL1]</li>
+     *  <li>int16 feature biases [NnueL1]</li>
+     *  <li>int8 hidden weights [NnueL2][2 * NnueL1]</li>
+     *  <li>int32 hidden biases [NnueL2]</li>
+     *  <li>int8 output weights [NnueL2]</li>
+     *  <li>int32 output bias</li>
+     * </ul>
+     * The hidden layer works in fixed point with a scale of
+     * 64; the output is divided by OutputDivisor to give a
+     * score in the units of the handcrafted evaluation.
+     *  </p>
+     *  <p>
+     * Inference uses AVX2 when the build targets it, and an
+     * equivalent scalar path otherwise. The scalar path is
+     * always built, so that nnuetool can check the other
+     * against it.
+     *  </p>
+     * </summary>
+     *
+     * @class Network
+     */
+    class Network final {
+    public:
+
+        /** The magic number at the start of a network file. */
+        static constexpr uint32_t Magic = 0x4E4E4342; // "BCNN"
+
+        /** The version of the network file format. */
+        static constexpr uint32_t Version = 1;
+
+        /** The fixed-point scale of the hidden layer weights. */
+        static constexpr int WeightShift = 6;
+
+        /** The divisor from network output to score. */
+        static constexpr int OutputDivisor = 16;
+
+        /**
+         * <summary>
+         * The header of a network file, padded so that the
+         * weights that follow are aligned for SIMD loads.
+         * </summary>
+         *
+         * @struct NnueHeader
+         */
+        struct NnueHeader final {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t inputs;
+            uint32_t l1;
+            uint32_t l2;
+            uint32_t padding[11];
+        };
+
+        /** The size of a network file, in bytes. */
+        static constexpr size_t FileSize =
+                sizeof(NnueHeader) +
+                sizeof(int16_t) * NnueInputs * NnueL1 +
+                sizeof(int16_t) * NnueL1 +
+                sizeof(int8_t)  * NnueL2 * 2 * NnueL1 +
+                sizeof(int32_t) * NnueL2 +
+                sizeof(int8_t)  * NnueL2 +
+                sizeof(int32_t);
+
+    private:
+
+        /**
+         * @private
+         * The mapping of the network file, or nullptr.
+         */
+        void* mapping;
+
+        /** @private The feature weights, in the mapping. */
+        const int16_t* featureWeights;
+
+        /** @private The feature biases, in the mapping. */
+        const int16_t* featureBiases;
+
+        /** @private The hidden weights, in the mapping. */
+        const int8_t* hiddenWeights;
+
+        /** @private The hidden biases, in the mapping. */
+        const int32_t* hiddenBiases;
+
+        /** @private The output weights, in the mapping. */
+        const int8_t* outputWeights;
+
+        /** @private The output bias, in the mapping. */
+        const int32_t* outputBias;
+
+        /**
+         * @private
+         * A method to unmap the current network, if any.
+         */
+        void unload();
+
+        /**
+         * @private
+         * A method to add or remove one feature from both
+         * perspectives of an accumulator.
+         *
+         * @tparam Add whether to add or remove the feature
+         * @tparam Simd whether or not to use AVX2
+         * @param acc the accumulator to update
+         * @param a the alliance of the piece
+         * @param pt the type of the piece
+         * @param sq the square of the piece
+         */
+        template<bool Add, bool Simd>
+        void toggle(Accumulator& acc, Alliance a,
+                    PieceType pt, int sq) const;
+
+    public:
+
+        /** A default constructor for an empty Network. */
+        Network();
+
+        /** A destructor, which unmaps the network file. */
+        ~Network();
+
+        /** @public Deleted copy constructor. */
+        Network(const Network&) = delete;
+
+        /**
+         * A method to map a network file into memory,
+         * replacing the current network.
+         *
+         * @param path the path of the network file
+         * @return whether or not the file was a valid network;
+         * if not, no network is loaded
+         */
+        bool load(const char* path);
+
+        /**
+         * A method to check whether a network is loaded.
+         *
+         * @return whether or not a network is loaded
+         */
+        [[nodiscard]]
+        constexpr bool loaded() const
+        { return mapping != nullptr; }
+
+        /**
+         * A method to compute an accumulator from scratch.
+         *
+         * @tparam Simd whether or not to use AVX2, which only a
+         * build with NnueSimd may ask for
+         * @param b the board to compute the accumulator of
+         * @param acc the accumulator to fill
+         */
+        template<bool Simd = NnueSimd>
+        void refresh(const Board& b, Accumulator& acc) const;
+
+        /**
+         * A method to compute the accumulator of the board
+         * after a move from the accumulator before it. The
+         * move must be the last move applied to the board.
+         *
+         * @tparam Simd whether or not to use AVX2, which only a
+         * build with NnueSimd may ask for
+         * @param b the board after the move
+         * @param m the move
+         * @param before the accumulator before the move
+         * @param after the accumulator to fill
+         */
+        template<bool Simd = NnueSimd>
+        void update(const Board& b, Move m,
+                    const Accumulator& before,
+                    Accumulator& after) const;
+
+        /**
+         * A method to evaluate a position from the perspective
+         * of the given player.
+         *
+         * @tparam Simd whether or not to use AVX2, which only a
+         * build with NnueSimd may ask for
+         * @param acc the accumulator of the position
+         * @param us the player to move
+         * @return the score of the position
+         */
+        template<bool Simd = NnueSimd>
+        [[nodiscard]]
+        int evaluate(const Accumulator& acc, Alliance us) const;
+    };
+}
+
+#endif //BITCHECKERS_NNUE_H
@@ -0,0 +1,130 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "board.h"
+#include "movegen.h"
+#include "nnue.h"
+
+using namespace checkers;
+using namespace checkers::opponent;
+
+/*
+ * A generator for network files, and a check of the inference
+ * paths against each other. It writes a network of seeded
+ * random weights, in the layout of the format, as a starting
+ * point to train from, and maps it back in as the engine
+ * does. It then plays random games and checks, at every
+ * position, that the accumulator kept up to date move by move
+ * matches the accumulator computed from scratch by the scalar
+ * path, and that the AVX2 path, when the build has it,
+ * evaluates the position exactly as the scalar path does.
+ *
+ * usage: nnuegen <network file> [games] [seed]
+ *
+ * The weights are drawn so that the accumulators leave the
+ * range of the activations both ways and the hidden weights
+ * reach the ends of their range, where the two paths are the
+ * most likely to part. The exit status is nonzero if they
+ * ever disagree.
+ */
+namespace {
+
+    /** The longest game played, in plies. */
+    constexpr int MaxGamePly = 200;
+
+    /**
+     * A method to write a network of random weights.
+     *
+     * @param path the path of the network file
+     * @param rng the random number generator
+     * @return whether or not the file was written
+     */
+    bool write(const char* const path, std::mt19937& rng) {
+        const auto uniform = [&rng](const int lo, const int hi)
+        { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+        Network::NnueHeader h{};
+        h.magic = Network::Magic;
+        h.version = Network::Version;
+        h.inputs = NnueInputs;
+        h.l1 = NnueL1;
+        h.l2 = NnueL2;
+        std::vector<int16_t> features(NnueInputs * NnueL1);
+        for(int16_t& w: features) w = (int16_t) uniform(-48, 48);
+        std::vector<int16_t> featureBiases(NnueL1);
+        for(int16_t& w: featureBiases) w = (int16_t) uniform(-32, 96);
+        std::vector<int8_t> hidden(NnueL2 * 2 * NnueL1);
+        for(int8_t& w: hidden) w = (int8_t) uniform(-128, 127);
+        std::vector<int32_t> hiddenBiases(NnueL2);
+        for(int32_t& w: hiddenBiases) w = uniform(-4096, 4096);
+        std::vector<int8_t> output(NnueL2);
+        for(int8_t& w: output) w = (int8_t) uniform(-128, 127);
+        const int32_t outputBias = uniform(-1024, 1024);
+
+        std::ofstream out(path, std::ios::binary);
+        out.write((const char*) &h, sizeof(h));
+        out.write((const char*) features.data(),
+                  (std::streamsize) (features.size() * sizeof(int16_t)));
+        out.write((const char*) featureBiases.data(),
+                  (std::streamsize) (featureBiases.size() * sizeof(int16_t)));
+        out.write((const char*) hidden.data(),
+                  (std::streamsize) hidden.size());
+        out.write((const char*) hiddenBiases.data(),
+                  (std::streamsize) (hiddenBiases.size() * sizeof(int32_t)));
+        out.write((const char*) output.data(),
+                  (std::streamsize) output.size());
+        out.write((const char*) &outputBias, sizeof(outputBias));
+        return (bool) out;
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        std::cerr << "usage: " << argv[0]
+                  << " <network file> [games] [seed]\n";
+        return 1;
+    }
+    const int games = argc > 2? std::atoi(argv[2]): 1000;
+    std::mt19937 rng(argc > 3? (unsigned) std::atoi(argv[3]): 1U);
+    if(!write(argv[1], rng)) {
+        std::cerr << "Cannot write " << argv[1] << '\n';
+        return 1;
+    }
+    Network network;
+    if(!network.load(argv[1])) {
+        std::cerr << "Cannot load " << argv[1] << '\n';
+        return 1;
+    }
+
+    uint64_t positions = 0, updates = 0, evaluations = 0;
+    for(int g = 0; g < games; ++g) {
+        State states[MaxGamePly + 1];
+        Board b = Board::Builder(states[0]).build();
+        Accumulator acc[MaxGamePly + 1];
+        network.refresh(b, acc[0]);
+        for(int ply = 0; ; ++ply) {
+            Accumulator scratch;
+            network.refresh<false>(b, scratch);
+            updates += std::memcmp(&scratch, &acc[ply], sizeof(scratch)) != 0;
+            for(const Alliance us: { White, Black })
+                evaluations += network.evaluate(scratch, us) !=
+                               network.evaluate<false>(scratch, us);
+            ++positions;
+            if(ply == MaxGamePly) break;
+            Move moves[movegen::MaxMoves];
+            const int n = (int) (movegen::generate<All>(moves, &b) - moves);
+            if(n == 0) break;
+            const Move m = moves[rng() % n];
+            b.applyMove(m, states[ply + 1]);
+            network.update(b, m, acc[ply], acc[ply + 1]);
+        }
+    }
+
+    std::cout << "positions " << positions
+              << " paths " << (NnueSimd? "avx2 scalar": "scalar")
+              << " update mismatches " << updates
+              << " evaluation mismatches " << evaluations << '\n';
+    return updates || evaluations? 1: 0;
+}
@@ -2,8 +2,712 @@
 // Created by evcmo on 10/30/2021.
 //
 
+#include <algorithm>
+#include <thread>
 #include "opponent.h"
 
 namespace checkers::opponent {
+    namespace {
 
-}
\ No newline at end of file
+        /** The ordering score of a jump. */
+        constexpr int JumpScore = 8 * History::MaxHistory;
+
+        /** The ordering score of the hash move. */
+        constexpr int HashScore = 16 * History::MaxHistory;
+
+        /** The initial half-width of an aspiration window. */
+        constexpr int AspirationDelta = 25;
+
+        /** The first depth searched with an aspiration window. */
+        constexpr int AspirationDepth = 4;
+
+        /** The least depth at which late moves are reduced. */
+        constexpr int ReductionDepth = 3;
+
+        /** The greatest depth at which moves are futile. */
+        constexpr int FutilityDepth = 2;
+
+        /** The futility margin, per ply of remaining depth. */
+        constexpr int FutilityMargin = 60;
+
+        /** The least depth at which ProbCut is tried. */
+        constexpr int ProbCutDepth = 5;
+
+        /** The depth reduction of a ProbCut verification. */
+        constexpr int ProbCutReduction = 4;
+
+        /** The margin above beta that ProbCut must beat. */
+        constexpr int ProbCutMargin = 80;
+
+        /** The number of moves ProbCut verifies. */
+        constexpr int ProbCutMoves = 3;
+
+        /**
+         * The progress of a known win for each king move its
+         * winner's kings have closed in on the loser's pieces.
+         */
+        constexpr int HuntValue = 8;
+
+        /**
+         * A method to compute the depth reduction of a late
+         * move, growing with the logarithms of both the depth
+         * and the move number.
+         *
+         * @param depth the remaining depth
+         * @param i the index of the move
+         * @return the reduction, in [1, depth - 2]
+         */
+        constexpr int reduction(const int depth, const int i) {
+            int r = 0;
+            for(int d = depth; d; d >>= 1)
+                for(int j = i; j; j >>= 1) ++r;
+            return std::clamp(r / 4, 1, depth - 2);
+        }
+
+        /**
+         * A method to move the highest scored move at or after
+         * the given index to the given index.
+         *
+         * @param moves the moves
+         * @param scores the scores of the moves
+         * @param i the index to fill
+         * @param n the number of moves
+         */
+        inline void
+        pickNext(Move* const moves, int* const scores,
+                 const int i, const int n) {
+            int best = i;
+            for(int j = i + 1; j < n; ++j)
+                if(scores[j] > scores[best]) best = j;
+            std::swap(moves[i], moves[best]);
+            std::swap(scores[i], scores[best]);
+        }
+
+        /**
+         * A method to measure how closely the kings of the
+         * given alliance hunt down the pieces of the other,
+         * since a won ending is converted by cornering them.
+         *
+         * @param b the board to measure
+         * @param a the alliance of the hunting kings
+         * @return for each king, the king moves it is short
+         * of the greatest distance to the nearest enemy piece
+         */
+        int hunt(const Board& b, const Alliance a) {
+            const uint64_t enemies = b.getPieces(~a, NullPT);
+            int v = 0;
+            for(uint64_t k = b.getPieces(a, King); k; k &= k - 1) {
+                const int from = bitScanFwd(k);
+                int nearest = 7;
+                for(uint64_t e = enemies; e; e &= e - 1) {
+                    const int to = bitScanFwd(e);
+                    nearest = std::min(nearest, std::max(
+                            abs((from >> 3) - (to >> 3)),
+                            abs((from & 7) - (to & 7))));
+                }
+                v += 7 - nearest;
+            }
+            return v;
+        }
+
+        /**
+         * A method to convert a score relative to the root
+         * into a score relative to the current node, for
+         * storage in the transposition table.
+         *
+         * @param score the score to convert
+         * @param ply the distance from the root
+         * @return the converted score
+         */
+        constexpr int scoreToTT(const int score, const int ply) {
+            return score >= MinKnownWinValue? score + ply:
+                   score <= -MinKnownWinValue? score - ply: score;
+        }
+
+        /**
+         * A method to convert a score from the transposition
+         * table back into a score relative to the root.
+         *
+         * @param score the score to convert
+         * @param ply the distance from the root
+         * @return the converted score
+         */
+        constexpr int scoreFromTT(const int score, const int ply) {
+            return score >= MinKnownWinValue? score - ply:
+                   score <= -MinKnownWinValue? score + ply: score;
+        }
+
+        /**
+         * A method to check whether a stored bound is enough
+         * to answer a search of the given window.
+         *
+         * @param e the stored entry
+         * @param score the stored score, relative to the root
+         * @param alpha the lower bound
+         * @param beta the upper bound
+         * @return whether or not the stored score may be
+         * returned directly
+         */
+        constexpr bool
+        cutsOff(const TTEntry& e, const int score,
+                const int alpha, const int beta) {
+            return e.bound == Exact ||
+                  (e.bound == Lower && score >= beta) ||
+                  (e.bound == Upper && score <= alpha);
+        }
+    }
+
+    Search::Search(const Board& b, TranspositionTable& t) :
+            board(b),
+            tt(t),
+            network(nullptr),
+            patterns(nullptr),
+            evalCache(nullptr),
+            database(nullptr),
+            firstDepth(1),
+            nodes(0),
+            countdown(CheckInterval),
+            stopped(false),
+            rootPlayer(b.currentPlayer()),
+            rootWon(false),
+            statsOut(nullptr),
+            stopRequest(false),
+            pondering(false),
+            ponderHit(false),
+            rootBest(NullMove),
+            pvLength{},
+            lineCount(0),
+            pvIndex(0)
+    { board.detach(rootState); }
+
+    void Search::setBoard(const Board& b) {
+        board = b;
+        board.detach(rootState);
+        rootPlayer = board.currentPlayer();
+        lineCount = 0;
+        lines[0] = PvLine();
+        rootBest = NullMove;
+    }
+
+    Move Search::ponderMove() const {
+        const PvLine& l = lines[0];
+        return l.turn < l.length? l.moves[l.turn]: NullMove;
+    }
+
+    bool Search::restricted(const int ply) const {
+        for(int i = 0; i < pvIndex; ++i) {
+            const PvLine& l = pending[i];
+            if(ply >= l.turn) continue;
+            int j = 0;
+            while(j < ply && l.moves[j] == states[j].previousMove()) ++j;
+            if(j == ply) return true;
+        }
+        return false;
+    }
+
+    bool Search::excluded(const Move m, const int ply) const {
+        for(int i = 0; i < pvIndex; ++i) {
+            const PvLine& l = pending[i];
+            if(ply != l.turn - 1 || l.moves[ply] != m) continue;
+            int j = 0;
+            while(j < ply && l.moves[j] == states[j].previousMove()) ++j;
+            if(j == ply) return true;
+        }
+        return false;
+    }
+
+    int Search::countMoves(const int ply) {
+        Move moves[movegen::MaxMoves];
+        const int n = (int)
+            (movegen::generate<All>(moves, &board) - moves);
+        int count = 0;
+        for(int i = 0; i < n; ++i) {
+            board.applyMove(moves[i], states[ply]);
+            count += board.getJumper()? countMoves(ply + 1): 1;
+            board.retractMove(moves[i]);
+        }
+        return count;
+    }
+
+    int Search::turnLength(const PvLine& l) const {
+        Board b = board;
+        State s[MaxPly];
+        int i = 0;
+        for(; i < l.length && b.currentPlayer() == rootPlayer; ++i)
+            b.applyMove(l.moves[i], s[i]);
+        return i;
+    }
+
+    void Search::poll() {
+        countdown = CheckInterval;
+        if(stopRequest.load(std::memory_order_relaxed)) {
+            stopped = true;
+            return;
+        }
+        if(ponderHit.exchange(false, std::memory_order_relaxed)) {
+            // The opponent's time is over: start our own clock.
+            timer.init(limits, rootPlayer);
+            pondering.store(false, std::memory_order_relaxed);
+        }
+        if(pondering.load(std::memory_order_relaxed)) return;
+        if(limits.nodes) {
+            if(nodes >= limits.nodes) stopped = true;
+            else countdown = std::min(CheckInterval,
+                                      limits.nodes - nodes);
+        }
+        if(timer.outOfTime()) stopped = true;
+    }
+
+    int Search::staticEval(const int ply) {
+        const uint64_t key = board.getKey();
+        int score;
+        if(evalCache) {
+            const bool hit = evalCache->probe(key, score);
+            SEARCH_STAT(stats.evalProbe(hit));
+            if(hit) return score;
+        }
+        if(network)
+            score = network->evaluate(accumulators[ply],
+                                      board.currentPlayer());
+        else {
+            score = evaluate(board);
+            if(patterns) {
+                const int p = patterns->evaluate(board);
+                score += board.currentPlayer() == White? p: -p;
+            }
+        }
+        score = std::clamp(score, 1 - MinKnownWinValue,
+                           MinKnownWinValue - 1);
+        if(evalCache) evalCache->store(key, score);
+        return score;
+    }
+
+    int Search::descend(const Alliance us, const int alpha,
+                        const int beta, const int depth,
+                        const int ply) {
+        return board.currentPlayer() == us?
+                 alphaBeta(alpha, beta, depth, ply + 1):
+                -alphaBeta(-beta, -alpha, depth - 1, ply + 1);
+    }
+
+    int Search::knownWin(const bool win, const int ply) {
+        const Alliance us = board.currentPlayer();
+        const int e = staticEval(ply);
+        const int progress = KnownWinProgress / 2 + (win?
+                e + HuntValue * hunt(board, us):
+               -e + HuntValue * hunt(board, ~us));
+        const int score = KnownWinValue - ply +
+                std::clamp(progress, 0, KnownWinProgress - 1);
+        return win? score: -score;
+    }
+
+    bool Search::probeBitbase(const int ply, bool& win) {
+        if(!options.bitbase || !ply || board.getJumper() ||
+           highBitCount(board.getAllPieces()) > egdb::BitbasePieces ||
+           !egdb::probeBitbase(board, win))
+            return false;
+        SEARCH_STAT(++stats.bitbaseHits);
+        return true;
+    }
+
+    int Search::quiesce(int alpha, int beta, const int ply) {
+        if(visit()) return 0;
+        SEARCH_STAT(stats.qvisit(ply));
+        pvLength[ply] = ply;
+        const Alliance us = board.currentPlayer();
+        if(!board.getPieces(us, NullPT)) return ply - WinValue;
+        if(ply >= MaxPly - 1) return staticEval(ply);
+
+        const uint64_t key = board.getKey();
+        TTEntry e{};
+        const bool hit = tt.probe(key, e);
+        SEARCH_STAT(stats.probe(hit));
+        if(hit) {
+            const int score = scoreFromTT(e.score, ply);
+            if(cutsOff(e, score, alpha, beta)) {
+                SEARCH_STAT(++stats.ttCutoffs);
+                return score;
+            }
+        }
+
+        // A won position in the bitbase needs no search, and
+        // any other is worth at most a draw.
+        bool win;
+        const bool held = probeBitbase(ply, win);
+        if(held && win) return knownWin(true, ply);
+        if(held) {
+            if(alpha >= 0) return 0;
+            beta = std::min(beta, 0);
+        }
+
+        Move moves[movegen::MaxMoves];
+        int scores[movegen::MaxMoves];
+        const int n = (int)
+            (movegen::generate<Aggressive>(moves, &board) - moves);
+
+        // Jumps are compulsory, so the current player may
+        // only stand pat when there is nothing to jump, and
+        // a player with no move at all has lost.
+        if(n == 0) {
+            if(movegen::generate<Passive>(moves, &board) == moves)
+                return ply - WinValue;
+            const int standPat = held? std::min(staticEval(ply), 0):
+                                staticEval(ply);
+            tt.store(key, NullMove,
+                     scoreToTT(standPat, ply), 0, Exact);
+            return standPat;
+        }
+
+        for(int i = 0; i < n; ++i)
+            scores[i] = hit && moves[i] == e.move;
+
+        const int alphaOrig = alpha;
+        int bestScore = -Infinity;
+        Move bestMove = NullMove;
+        for(int i = 0; i < n; ++i) {
+            pickNext(moves, scores, i, n);
+            const Move m = moves[i];
+            makeMove(m, ply);
+            const int score = board.currentPlayer() == us?
+                     quiesce(alpha, beta, ply + 1):
+                    -quiesce(-beta, -alpha, ply + 1);
+            board.retractMove(m);
+            if(stopped) return 0;
+            if(score > bestScore) {
+                bestScore = score;
+                bestMove = m;
+                if(score > alpha) alpha = score;
+                if(alpha >= beta) break;
+            }
+        }
+        if(held) bestScore = std::min(bestScore, 0);
+        tt.store(key, bestMove, scoreToTT(bestScore, ply), 0,
+                 bestScore >= beta? Lower:
+                 bestScore > alphaOrig? Exact: Upper);
+        return bestScore;
+    }
+
+    int Search::alphaBeta(int alpha, int beta,
+                          const int depth, const int ply) {
+        if(depth <= 0 || ply >= MaxPly - 1)
+            return quiesce(alpha, beta, ply);
+        if(visit()) return 0;
+        SEARCH_STAT(stats.visit(ply));
+        pvLength[ply] = ply;
+
+        const bool pvNode = beta - alpha > 1;
+        // Until the move from the root is complete, the moves
+        // that complete the lines already found are left out,
+        // and the score does not describe the position.
+        const bool partial = pvIndex && (ply == 0 || board.getJumper()) &&
+                             restricted(ply);
+        const uint64_t key = board.getKey();
+        TTEntry e{};
+        const bool hit = tt.probe(key, e);
+        SEARCH_STAT(stats.probe(hit));
+        if(hit && !pvNode && !partial && e.depth >= depth) {
+            const int score = scoreFromTT(e.score, ply);
+            if(cutsOff(e, score, alpha, beta)) {
+                SEARCH_STAT(++stats.ttCutoffs);
+                return score;
+            }
+        }
+        // Below a won root, the positions that keep the win
+        // are searched for the way to convert it, and scored
+        // as known wins only at the horizon.
+        bool win;
+        const bool held = probeBitbase(ply, win) && !(win && rootWon &&
+                          board.currentPlayer() == rootPlayer);
+        if(held && win) {
+            const int score = knownWin(true, ply);
+            tt.store(key, NullMove, scoreToTT(score, ply),
+                     depth, Exact);
+            return score;
+        }
+        if(held) {
+            if(alpha >= 0) return 0;
+            beta = std::min(beta, 0);
+        }
+        // A position in the endgame database needs no search,
+        // but the root still needs a move. Below a won root,
+        // the positions that keep the win are searched for the
+        // way to convert it, and scored as known wins only
+        // near the horizon.
+        const bool shallow = depth < options.egdbDepth;
+        if(database && ply && (!shallow || rootWon) &&
+           !board.getJumper() && highBitCount(board.getAllPieces()) <=
+           std::min(options.egdbPieces, database->pieces())) {
+            SEARCH_STAT(++stats.egdbProbes);
+            const egdb::Value v = database->probe(board);
+            const egdb::Value kept = board.currentPlayer() == rootPlayer?
+                    egdb::Win: egdb::Loss;
+            if(v != egdb::Unknown && (shallow || !rootWon || v != kept)) {
+                SEARCH_STAT(++stats.egdbHits);
+                const int score = v == egdb::Draw? 0:
+                                  knownWin(v == egdb::Win, ply);
+                tt.store(key, NullMove, scoreToTT(score, ply),
+                         depth, Exact);
+                return score;
+            }
+        }
+
+        const Move hashMove =
+                ply == 0 && pvIndex < lineCount?
+                    lines[pvIndex].moves[0]:
+                ply == 0 && rootBest != NullMove? rootBest:
+                hit? e.move: NullMove;
+
+        Move moves[movegen::MaxMoves];
+        int scores[movegen::MaxMoves];
+        const int n = (int)
+            (movegen::generate<All>(moves, &board) - moves);
+        if(n == 0) return ply - WinValue;
+
+        const Alliance us = board.currentPlayer();
+        const Move prev = board.getState()->previousMove();
+        for(int i = 0; i < n; ++i)
+            scores[i] =
+                moves[i] == hashMove? HashScore:
+                moves[i].moveType() == Aggressive? JumpScore:
+                history.score(us, ply, prev, moves[i]);
+
+        // Jumps are compulsory, so either every move is a
+        // jump or none is.
+        const bool quiet = moves[0].moveType() != Aggressive;
+
+        // ProbCut: if one of the best few moves beats beta by
+        // a margin in a shallow search, a full search would
+        // almost surely beat beta too.
+        const int probBeta = beta + ProbCutMargin;
+        if(options.probCut && !pvNode && !held && !partial &&
+           depth >= ProbCutDepth &&
+           abs(beta) < MinKnownWinValue && !(hit &&
+           e.depth >= depth - ProbCutReduction &&
+           scoreFromTT(e.score, ply) < probBeta)) {
+            for(int i = 0; i < n && i < ProbCutMoves; ++i) {
+                pickNext(moves, scores, i, n);
+                const Move m = moves[i];
+                SEARCH_STAT(++stats.probCutTries);
+                makeMove(m, ply);
+                const int score = descend(us, probBeta - 1, probBeta,
+                                          depth - ProbCutReduction, ply);
+                board.retractMove(m);
+                if(stopped) return 0;
+                if(score >= probBeta) {
+                    SEARCH_STAT(++stats.probCutCutoffs);
+                    tt.store(key, m, scoreToTT(score, ply),
+                             depth - ProbCutReduction, Lower);
+                    return score;
+                }
+            }
+        }
+
+        // Futility pruning: near the leaves, quiet moves
+        // cannot lift a hopeless static score above alpha.
+        int futilityValue = -Infinity;
+        if(options.futilityPruning && !pvNode && quiet &&
+           depth <= FutilityDepth && abs(alpha) < MinKnownWinValue) {
+            futilityValue = staticEval(ply) + FutilityMargin * depth;
+            if(futilityValue > alpha) futilityValue = -Infinity;
+        }
+
+        Move quiets[movegen::MaxMoves];
+        int quietCount = 0;
+        const int alphaOrig = alpha;
+        int bestScore = -Infinity;
+        Move bestMove = NullMove;
+        int moveCount = 0;
+        for(int i = 0; i < n; ++i) {
+            pickNext(moves, scores, i, n);
+            const Move m = moves[i];
+            if(partial && excluded(m, ply)) continue;
+            const int k = moveCount++;
+            if(k > 0 && futilityValue != -Infinity) {
+                SEARCH_STAT(++stats.futilityPrunes);
+                bestScore = std::max(bestScore, futilityValue);
+                continue;
+            }
+            makeMove(m, ply);
+            // Only the first move is searched with the full
+            // window; the rest need only prove themselves
+            // worse, unless they fail high. Late quiet moves
+            // other than killers and counters are first tried
+            // at reduced depth.
+            int score;
+            if(k == 0)
+                score = descend(us, alpha, beta, depth, ply);
+            else {
+                const int r =
+                    options.lateMoveReductions && quiet &&
+                    depth >= ReductionDepth && k >= (pvNode? 3: 2) &&
+                    scores[i] < History::CounterScore?
+                    reduction(depth, k): 0;
+                SEARCH_STAT(stats.reductions += r > 0);
+                score = descend(us, alpha, alpha + 1, depth - r, ply);
+                if(r && score > alpha) {
+                    SEARCH_STAT(++stats.reductionResearches);
+                    score = descend(us, alpha, alpha + 1, depth, ply);
+                }
+                if(score > alpha && score < beta) {
+                    SEARCH_STAT(++stats.researches);
+                    score = descend(us, alpha, beta, depth, ply);
+                }
+            }
+            board.retractMove(m);
+            if(stopped) return 0;
+            if(score > bestScore) {
+                bestScore = score;
+                bestMove = m;
+                if(score > alpha) {
+                    alpha = score;
+                    if(ply == 0 && pvIndex == 0) rootBest = m;
+                    pv[ply][ply] = m;
+                    for(int j = ply + 1; j < pvLength[ply + 1]; ++j)
+                        pv[ply][j] = pv[ply + 1][j];
+                    pvLength[ply] = pvLength[ply + 1];
+                }
+                if(alpha >= beta) {
+                    SEARCH_STAT(++stats.betaCutoffs);
+                    SEARCH_STAT(stats.firstMoveCutoffs += k == 0);
+                    if(m.moveType() != Aggressive) {
+                        if(m == history.killer(ply, 0) ||
+                           m == history.killer(ply, 1))
+                            SEARCH_STAT(++stats.killerCutoffs);
+                        else if(m == history.counter(us, prev))
+                            SEARCH_STAT(++stats.counterCutoffs);
+                        else SEARCH_STAT(++stats.historyCutoffs);
+                        history.update(us, ply, prev, m,
+                                       depth, quiets, quietCount);
+                    }
+                    break;
+                }
+            }
+            if(m.moveType() != Aggressive)
+                quiets[quietCount++] = m;
+        }
+        if(held) bestScore = std::min(bestScore, 0);
+        if(!partial)
+            tt.store(key, bestMove, scoreToTT(bestScore, ply), depth,
+                     bestScore >= beta? Lower:
+                     bestScore > alphaOrig? Exact: Upper);
+        return bestScore;
+    }
+
+    int Search::aspirate(const int depth, const int center) {
+        if(depth < AspirationDepth)
+            return alphaBeta(-Infinity, Infinity, depth, 0);
+        int delta = AspirationDelta,
+            alpha = std::max(center - delta, -Infinity),
+            beta  = std::min(center + delta,  Infinity);
+        for(;;) {
+            const int score = alphaBeta(alpha, beta, depth, 0);
+            if(stopped) return score;
+            if(score <= alpha) {
+                beta  = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -Infinity);
+            } else if(score >= beta)
+                beta  = std::min(score + delta, Infinity);
+            else return score;
+            SEARCH_STAT(++stats.aspirationFails);
+            delta += delta / 2;
+            // Wins and losses are exact, so there is nothing
+            // left to aspire to: open the window completely.
+            if(abs(score) >= MinWinValue) {
+                alpha = -Infinity;
+                beta  =  Infinity;
+            }
+        }
+    }
+
+    Move Search::think(const SearchLimits& l) {
+        limits = l;
+        rootPlayer = board.currentPlayer();
+        timer.init(l, rootPlayer);
+        pondering.store(l.ponder, std::memory_order_relaxed);
+        nodes = 0;
+        countdown = 1;
+        stopped = false;
+        stats.clear();
+        history.age();
+        if(network) network->refresh(board, accumulators[0]);
+        lineCount = 0;
+        pvIndex = 0;
+        const int pieces = highBitCount(board.getAllPieces());
+        bool win = false;
+        rootWon = !board.getJumper() &&
+                 ((options.bitbase && pieces <= egdb::BitbasePieces &&
+                   egdb::probeBitbase(board, win) && win) ||
+                  (database && pieces <= std::min(options.egdbPieces,
+                                                  database->pieces()) &&
+                   database->probe(board) == egdb::Win));
+
+        // Until the first iteration completes, any legal
+        // move is better than none.
+        Move moves[movegen::MaxMoves];
+        const int n = (int)
+            (movegen::generate<All>(moves, &board) - moves);
+        rootBest = n? moves[0]: NullMove;
+        lines[0] = PvLine();
+        if(n == 0) return NullMove;
+
+        // A multi-jump is one move, however many ways there
+        // are to begin it.
+        const int choices = countMoves(0);
+        const int depth = std::min(limits.depth, MaxDepth);
+        const int multiPV =
+                std::clamp(options.multiPV, 1, std::min(choices, MaxMultiPV));
+        for(int d = std::min(firstDepth, depth); d <= depth; ++d) {
+            const int64_t begin = timer.elapsed();
+            // Each pass excludes the root moves of the lines
+            // found before it, and shares the transposition
+            // table with them.
+            for(pvIndex = 0; pvIndex < multiPV; ++pvIndex) {
+                const uint64_t before = nodes;
+                const int center =
+                        pvIndex < lineCount? lines[pvIndex].score:
+                        pvIndex > 0? pending[pvIndex - 1].score: 0;
+                const int score = aspirate(d, center);
+                if(stopped) break;
+                PvLine& line = pending[pvIndex];
+                line.length = pvLength[0];
+                for(int j = 0; j < line.length; ++j)
+                    line.moves[j] = pv[0][j];
+                line.turn = turnLength(line);
+                line.score = score;
+                line.depth = d;
+                line.nodes = nodes - before;
+            }
+            if(stopped) break;
+            pvIndex = 0;
+            lineCount = multiPV;
+            for(int i = 0; i < multiPV; ++i) {
+                int j = i;
+                for(; j > 0 && lines[j - 1].score < pending[i].score; --j)
+                    lines[j] = lines[j - 1];
+                lines[j] = pending[i];
+            }
+            rootBest = lines[0].moves[0];
+            timer.iterationDone(timer.elapsed() - begin);
+#ifndef NSTATS
+            stats.iterationDone();
+            if(statsOut)
+                *statsOut << "stats depth " << d << ' ' << stats << '\n';
+#endif
+            if(isPondering()) continue;
+            if(choices == 1 && timer.isTimed()) break;
+            if(!timer.startNextIteration()) break;
+        }
+        pvIndex = 0;
+        // A ponder search may not answer before the opponent
+        // has moved, even if it has nothing left to search.
+        while(isPondering() &&
+              !stopRequest.load(std::memory_order_relaxed)) {
+            if(ponderHit.exchange(false, std::memory_order_relaxed))
+                pondering.store(false, std::memory_order_relaxed);
+            else std::this_thread::sleep_for(
+                    std::chrono::microseconds(100));
+        }
+        pondering.store(false, std::memory_order_relaxed);
+        return rootBest;
+    }
+}
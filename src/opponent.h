@@ -5,9 +5,812 @@
 #ifndef BITCHECKERS_OPPONENT_H
 #define BITCHECKERS_OPPONENT_H
 
+#include <atomic>
+#include "board.h"
+#include "movegen.h"
+#include "history.h"
+#include "statistics.h"
+#include "ttable.h"
+#include "timeman.h"
+#include "evaluation.h"
+#include "nnue.h"
+#include "evalcache.h"
+#include "patterns.h"
+#include "egdbfile.h"
+#include "bitbase.h"
 
 namespace checkers::opponent {
+    using namespace utility;
 
+    /** A score larger than any reachable score. */
+    constexpr int Infinity = 32000;
+
+    /** The score of a won position at the root. */
+    constexpr int WinValue = 31000;
+
+    /** The lowest score of a forced win. */
+    constexpr int MinWinValue = WinValue - MaxPly;
+
+    /**
+     * The number of scores that tell apart the positions held
+     * as won by the progress the winner has made.
+     */
+    constexpr int KnownWinProgress = 2048;
+
+    /**
+     * The score of a position the endgame database or the
+     * bitbase holds as won, at the root, before its progress
+     * is added: with it, below any forced win found by the
+     * search.
+     */
+    constexpr int KnownWinValue = MinWinValue - KnownWinProgress;
+
+    /**
+     * The lowest score of a known win, above any evaluation.
+     * Like forced wins, known wins are stored in the
+     * transposition table relative to the node, and are not
+     * pruned as ordinary scores.
+     */
+    constexpr int MinKnownWinValue = KnownWinValue - MaxPly;
+
+    /**
+     * <summary>
+     * Runtime switches for the selective parts of the search,
+     * so that each may be measured against the others in
+     * self-play without rebuilding.
+     * </summary>
+     *
+     * @struct SearchOptions
+     */
+    struct SearchOptions final {
+
+        /** Whether or not to reduce the depth of late moves. */
+        bool lateMoveReductions = true;
+
+        /** Whether or not to prune hopeless moves near leaves. */
+        bool futilityPruning = true;
+
+        /**
+         * Whether or not to cut nodes whose best moves beat
+         * beta by a margin in a shallow search.
+         */
+        bool probCut = true;
+
+        /**
+         * The number of principal variations to search, each
+         * with an exact score. More than one is only useful
+         * for analysis.
+         */
+        int multiPV = 1;
+
+        /**
+         * Whether or not to look up positions of few pieces in
+         * the bitbase linked into the engine.
+         */
+        bool bitbase = true;
+
+        /**
+         * The most pieces a position may have to be probed in
+         * the endgame database.
+         */
+        int egdbPieces = 8;
+
+        /**
+         * The least depth left at which the endgame database is
+         * probed, so that the nodes nearest the leaves, which
+         * are many and touch many blocks, are left to the
+         * evaluation.
+         */
+        int egdbDepth = 2;
+    };
+
+    /** The maximum number of principal variations. */
+    constexpr int MaxMultiPV = 32;
+
+    /**
+     * <summary>
+     * A principal variation from the root, with its score,
+     * the depth it was searched to, and the number of nodes
+     * spent on it.
+     * </summary>
+     *
+     * @struct PvLine
+     */
+    struct PvLine final {
+
+        /** The moves of this line. */
+        Move moves[MaxPly];
+
+        /** The number of moves in this line. */
+        int length = 0;
+
+        /**
+         * The number of moves at the head of this line that
+         * make up the move from the root, more than one when
+         * it is a multi-jump.
+         */
+        int turn = 0;
+
+        /** The exact score of this line. */
+        int score = 0;
+
+        /** The depth this line was searched to. */
+        int depth = 0;
+
+        /** The number of nodes spent on this line. */
+        uint64_t nodes = 0;
+
+        /**
+         * An overloaded insertion operator to print this line
+         * as key/value pairs, with its moves in standard
+         * notation.
+         *
+         * @param out the output stream to use
+         * @param line the line to print
+         * @return a reference to the output stream, for
+         * chaining purposes
+         */
+        friend std::ostream&
+        operator<<(std::ostream& out, const PvLine& line) {
+            out << "depth " << line.depth
+                << " score " << line.score
+                << " nodes " << line.nodes
+                << " pv";
+            for(int i = 0; i < line.length; ++i)
+                out << ' ' << line.moves[i].notation();
+            return out;
+        }
+    };
+
+    /**
+     * <summary>
+     * A single-threaded alpha-beta search. Each Search owns
+     * its own board, state stack, move ordering tables and
+     * statistics, so that several searches may run side by
+     * side without sharing anything.
+     * </summary>
+     *
+     * @class Search
+     */
+    class Search final {
+    private:
+
+        /**
+         * @private
+         * The board to search.
+         */
+        Board board;
+
+        /**
+         * @private
+         * A copy of the state of the board at the root, so
+         * that the search never depends on the caller's state
+         * stack.
+         */
+        State rootState;
+
+        /**
+         * @private
+         * The transposition table, which may be shared with
+         * other searches.
+         */
+        TranspositionTable& tt;
+
+        /**
+         * @private
+         * One state for each ply of the search.
+         */
+        State states[MaxPly];
+
+        /**
+         * @private
+         * The network to evaluate with, or nullptr to use the
+         * handcrafted evaluation.
+         */
+        const Network* network;
+
+        /**
+         * @private
+         * The pattern weights to add to the handcrafted
+         * evaluation, or nullptr.
+         */
+        const Patterns* patterns;
+
+        /**
+         * @private
+         * The cache of static evaluations, or nullptr.
+         */
+        EvalCache* evalCache;
+
+        /**
+         * @private
+         * The endgame database, or nullptr.
+         */
+        const egdb::Database* database;
+
+        /**
+         * @private
+         * The network accumulator of each ply, kept only when
+         * there is a network.
+         */
+        Accumulator accumulators[MaxPly];
+
+        /**
+         * @private
+         * The move ordering tables.
+         */
+        History history;
+
+        /**
+         * @private
+         * The statistics for this search.
+         */
+        SearchStats stats;
+
+        /**
+         * @private
+         * The selective search switches.
+         */
+        SearchOptions options;
+
+        /**
+         * @private
+         * The limits of the current search.
+         */
+        SearchLimits limits;
+
+        /**
+         * @private
+         * The time controller of the current search.
+         */
+        TimeManager timer;
+
+        /**
+         * @private
+         * The depth of the first iteration.
+         */
+        int firstDepth;
+
+        /**
+         * @private
+         * The number of nodes visited by the current search.
+         */
+        uint64_t nodes;
+
+        /**
+         * @private
+         * The number of nodes left until the limits are
+         * checked again.
+         */
+        uint64_t countdown;
+
+        /**
+         * @private
+         * Whether or not the current search has hit one of
+         * its limits.
+         */
+        bool stopped;
+
+        /**
+         * @private
+         * The player to move at the root.
+         */
+        Alliance rootPlayer;
+
+        /**
+         * @private
+         * Whether or not the root is known to be won by the
+         * player to move there, so that the positions below
+         * it that keep the win are searched rather than
+         * scored alike.
+         */
+        bool rootWon;
+
+        /**
+         * @private
+         * The stream to print statistics to at the end of each
+         * iteration, if any.
+         */
+        std::ostream* statsOut;
+
+        /**
+         * @private
+         * A request from another thread to stop searching.
+         */
+        std::atomic<bool> stopRequest;
+
+        /**
+         * @private
+         * Whether or not the current search is running on the
+         * opponent's time, ignoring its time limits.
+         */
+        std::atomic<bool> pondering;
+
+        /**
+         * @private
+         * A notice from another thread that the opponent has
+         * played the move being pondered.
+         */
+        std::atomic<bool> ponderHit;
+
+        /**
+         * @private
+         * The best move found at the root.
+         */
+        Move rootBest;
+
+
+        /**
+         * @private
+         * A triangular table of principal variations, one
+         * for each ply.
+         */
+        Move pv[MaxPly][MaxPly];
+
+        /**
+         * @private
+         * The length of the principal variation at each ply.
+         */
+        int pvLength[MaxPly];
+
+        /**
+         * @private
+         * The principal variations of the last completed
+         * iteration, best first.
+         */
+        PvLine lines[MaxMultiPV];
+
+        /**
+         * @private
+         * The principal variations of the current iteration,
+         * in the order they were found.
+         */
+        PvLine pending[MaxMultiPV];
+
+        /**
+         * @private
+         * The number of principal variations in lines.
+         */
+        int lineCount;
+
+        /**
+         * @private
+         * The index of the principal variation being searched.
+         * Moves from the root that head the variations found
+         * before it in this iteration are excluded.
+         */
+        int pvIndex;
+
+        /**
+         * @private
+         * A method to search the current position to the
+         * given depth with a fail-soft alpha-beta.
+         *
+         * @param alpha the lower bound
+         * @param beta the upper bound
+         * @param depth the remaining depth
+         * @param ply the distance from the root
+         * @return the score of the current position
+         */
+        int alphaBeta(int alpha, int beta, int depth, int ply);
+
+        /**
+         * @private
+         * A method to count a node, checking the limits of
+         * the search once every CheckInterval nodes.
+         *
+         * @return whether or not the search must stop
+         */
+        bool visit() {
+            ++nodes;
+            if(--countdown == 0) poll();
+            return stopped;
+        }
+
+        /**
+         * @private
+         * A method to check the node and time limits of the
+         * search, stopping it if either has been reached, and
+         * to act on requests from other threads.
+         */
+        void poll();
+
+        /**
+         * @private
+         * A method to apply a move at the given ply, updating
+         * the network accumulator of the next ply.
+         *
+         * @param m the move to apply
+         * @param ply the distance from the root
+         */
+        void makeMove(const Move m, const int ply) {
+            board.applyMove(m, states[ply]);
+            if(network)
+                network->update(board, m, accumulators[ply],
+                                accumulators[ply + 1]);
+        }
+
+        /**
+         * @private
+         * A method to evaluate the current position, with the
+         * network if there is one, or else with the handcrafted
+         * evaluation and any patterns, through the evaluation
+         * cache if there is one. The score always lies
+         * strictly between the scores of known losses and
+         * wins.
+         *
+         * @param ply the distance from the root
+         * @return the score of the current position
+         */
+        int staticEval(int ply);
+
+        /**
+         * @private
+         * A method to search the position reached by a move
+         * made by the given player. The score is negated and
+         * the depth is spent only if the turn has passed;
+         * otherwise a multi-jump continues, for free.
+         *
+         * @param us the player who made the move
+         * @param alpha the lower bound, for the given player
+         * @param beta the upper bound, for the given player
+         * @param depth the remaining depth before the move
+         * @param ply the distance from the root before the move
+         * @return the score of the position, for the given
+         * player
+         */
+        int descend(Alliance us, int alpha, int beta,
+                    int depth, int ply);
+
+        /**
+         * @private
+         * A method to search the root inside an aspiration
+         * window centered on the given score, widening the
+         * window each time the search falls outside of it.
+         *
+         * @param depth the depth to search
+         * @param center the expected score
+         * @return the score of the root
+         */
+        int aspirate(int depth, int center);
+
+        /**
+         * @private
+         * A method to check whether the current node lies
+         * within the move from the root of one of the
+         * principal variations already found in this
+         * iteration, so that its search leaves moves out.
+         *
+         * @param ply the distance from the root
+         * @return whether or not the node is restricted
+         */
+        [[nodiscard]]
+        bool restricted(int ply) const;
+
+        /**
+         * @private
+         * A method to check whether a move from a restricted
+         * node completes the move from the root of one of the
+         * principal variations already found in this
+         * iteration. A multi-jump is excluded only as a whole,
+         * so that another way to continue it stays open.
+         *
+         * @param m the move to check
+         * @param ply the distance from the root
+         * @return whether or not the move is excluded
+         */
+        [[nodiscard]]
+        bool excluded(Move m, int ply) const;
+
+        /**
+         * @private
+         * A method to count the moves of the player to move,
+         * counting each way to complete a multi-jump as a
+         * move of its own.
+         *
+         * @param ply the distance from the root
+         * @return the number of moves
+         */
+        int countMoves(int ply);
+
+        /**
+         * @private
+         * A method to count the moves at the head of the given
+         * line that the player to move at the root makes
+         * before the turn passes.
+         *
+         * @param l a line from the root
+         * @return the number of moves of the move from the root
+         */
+        [[nodiscard]]
+        int turnLength(const PvLine& l) const;
+
+        /**
+         * @private
+         * A method to score the current position as a known
+         * win or loss, adding the progress of the winner so
+         * that the search makes its way toward converting it.
+         *
+         * @param win whether or not the player to move wins
+         * @param ply the distance from the root
+         * @return the score of the current position
+         */
+        int knownWin(bool win, int ply);
+
+        /**
+         * @private
+         * A method to look up the current position in the
+         * bitbase, below the root and between jumps only.
+         *
+         * @param ply the distance from the root
+         * @param win whether or not the player to move wins,
+         * to fill if the position is held
+         * @return whether or not the bitbase holds the position
+         */
+        bool probeBitbase(int ply, bool& win);
+
+        /**
+         * @private
+         * A method to search only jumps until the position
+         * is quiet, so that the horizon never falls in the
+         * middle of a forced exchange.
+         *
+         * @param alpha the lower bound
+         * @param beta the upper bound
+         * @param ply the distance from the root
+         * @return the score of the current position
+         */
+        int quiesce(int alpha, int beta, int ply);
+
+    public:
+
+        /**
+         * A public constructor for a Search.
+         *
+         * @param b the board to search, which is copied
+         * @param t the transposition table to use
+         */
+        Search(const Board& b, TranspositionTable& t);
+
+        /** @public Deleted copy constructor. */
+        Search(const Search&) = delete;
+
+        /**
+         * A method to replace the board to search. Only the
+         * ordering tables carry over from the previous board.
+         *
+         * @param b the board to search, which is copied
+         */
+        void setBoard(const Board& b);
+
+        /**
+         * A method to request that the current search stop as
+         * soon as possible. This may be called from any
+         * thread; the request stands until cleared.
+         */
+        void requestStop()
+        { stopRequest.store(true, std::memory_order_relaxed); }
+
+        /**
+         * A method to clear any request to stop and any ponder
+         * hit left over, before the next search is started.
+         */
+        void clearSignals() {
+            stopRequest.store(false, std::memory_order_relaxed);
+            ponderHit.store(false, std::memory_order_relaxed);
+        }
+
+        /**
+         * A method to notify a pondering search that the
+         * opponent played the expected move. The search goes
+         * on as a normal search, its time limits counted from
+         * now. This may be called from any thread.
+         */
+        void ponderhit()
+        { ponderHit.store(true, std::memory_order_relaxed); }
+
+        /**
+         * A method to check whether the current search is
+         * pondering.
+         *
+         * @return whether or not the search is pondering
+         */
+        [[nodiscard]]
+        bool isPondering() const
+        { return pondering.load(std::memory_order_relaxed); }
+
+        /**
+         * A method to change the evaluation, effective from
+         * the next call to think.
+         *
+         * @param n the network to evaluate with, which must
+         * outlive the search, or nullptr or an empty network
+         * to use the handcrafted evaluation
+         */
+        constexpr void setNetwork(const Network* const n)
+        { network = n && n->loaded()? n: nullptr; }
+
+        /**
+         * A method to change the pattern weights added to the
+         * handcrafted evaluation, effective from the next call
+         * to think. They are not used with a network.
+         *
+         * @param p the pattern weights, which must outlive the
+         * search, or nullptr or empty weights for none
+         */
+        constexpr void setPatterns(const Patterns* const p)
+        { patterns = p && p->loaded()? p: nullptr; }
+
+        /**
+         * A method to change the evaluation cache, effective
+         * from the next call to think. The cache must be
+         * cleared whenever the evaluation changes.
+         *
+         * @param c the cache to use, which must outlive the
+         * search and may be shared, or nullptr for none
+         */
+        constexpr void setEvalCache(EvalCache* const c)
+        { evalCache = c; }
+
+        /**
+         * A method to change the endgame database, effective
+         * from the next call to think. Which positions are
+         * probed is set by the search options.
+         *
+         * @param d the database, which must outlive the search
+         * and may be shared, or nullptr or an empty database
+         * for none
+         */
+        constexpr void setEndgameDatabase(const egdb::Database* const d)
+        { database = d && d->pieces()? d: nullptr; }
+
+        /**
+         * A method to change the selective search switches,
+         * effective from the next call to think.
+         *
+         * @param o the new switches
+         */
+        constexpr void setOptions(const SearchOptions& o)
+        { options = o; }
+
+        /**
+         * A method to change the depth of the first iteration,
+         * effective from the next call to think. Searches
+         * helping each other on a shared table start at
+         * different depths, so that they do not search the
+         * same iterations in step.
+         *
+         * @param d the depth of the first iteration
+         */
+        constexpr void setFirstDepth(const int d)
+        { firstDepth = d < 1? 1: d; }
+
+        /**
+         * A method to print the statistics of the search, as
+         * one line of key/value pairs, at the end of each
+         * iteration. Nothing is printed in a build with
+         * NSTATS.
+         *
+         * @param out the stream to print to, or nullptr to
+         * print nothing
+         */
+        constexpr void setStatisticsOutput(std::ostream* const out)
+        { statsOut = out; }
+
+        /**
+         * The number of nodes between two checks of the
+         * limits of the search, small enough that a stop is
+         * seen well within a millisecond.
+         */
+        static constexpr uint64_t CheckInterval = 1024;
+
+        /**
+         * A method to search the board by iterative deepening.
+         * A new iteration is started only if the time
+         * controller expects it to complete in time. The
+         * transposition table is not aged here: its owner calls
+         * newSearch once before the searches sharing it start.
+         *
+         * @param l the limits of the search
+         * @return the best move, or the null move if the
+         * current player has no moves
+         */
+        Move think(const SearchLimits& l);
+
+        /**
+         * A method to expose the number of nodes visited by
+         * the last search.
+         *
+         * @return the number of nodes visited
+         */
+        [[nodiscard]]
+        constexpr uint64_t nodeCount() const
+        { return nodes; }
+
+        /**
+         * A method to expose the score of the last completed
+         * iteration.
+         *
+         * @return the score of the last completed iteration
+         */
+        [[nodiscard]]
+        constexpr int score() const
+        { return lines[0].score; }
+
+        /**
+         * A method to expose the principal variation of the
+         * last completed iteration.
+         *
+         * @return the first move of the principal variation
+         */
+        [[nodiscard]]
+        constexpr const Move* principalVariation() const
+        { return lines[0].moves; }
+
+        /**
+         * A method to expose the length of the principal
+         * variation of the last completed iteration.
+         *
+         * @return the length of the principal variation
+         */
+        [[nodiscard]]
+        constexpr int principalVariationLength() const
+        { return lines[0].length; }
+
+        /**
+         * A method to expose the expected reply to the best
+         * move, which is the move to ponder on. If the best
+         * move starts a multi-jump, the reply is the first
+         * opponent move after the jump is complete.
+         *
+         * @return the first opponent move of the principal
+         * variation, or the null move if there is none
+         */
+        [[nodiscard]]
+        Move ponderMove() const;
+
+        /**
+         * A method to expose the number of principal
+         * variations of the last completed iteration. This is
+         * the multiPV option, limited by the number of legal
+         * moves.
+         *
+         * @return the number of principal variations
+         */
+        [[nodiscard]]
+        constexpr int variationCount() const
+        { return lineCount; }
+
+        /**
+         * A method to expose a principal variation of the
+         * last completed iteration, best first.
+         *
+         * @param i the index of the principal variation
+         * @return the principal variation
+         */
+        [[nodiscard]]
+        constexpr const PvLine& line(const int i) const
+        { return lines[i]; }
+
+        /**
+         * A method to expose the statistics of this search.
+         *
+         * @return the statistics of this search
+         */
+        [[nodiscard]]
+        constexpr const SearchStats& statistics() const
+        { return stats; }
+
+        /**
+         * A method to expose the move ordering tables of
+         * this search.
+         *
+         * @return the move ordering tables of this search
+         */
+        [[nodiscard]]
+        constexpr const History& ordering() const
+        { return history; }
+    };
 }
 
 
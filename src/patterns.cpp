@@ -0,0 +1,134 @@
+#include <fstream>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#include "patterns.h"
+
+namespace checkers::opponent {
+    namespace {
+
+        /**
+         * <summary>
+         * The masks of the regions, and a map from the bits of
+         * a region to the ternary index of the same squares
+         * holding pieces of the first alliance.
+         * </summary>
+         *
+         * @struct RegionTables
+         */
+        struct RegionTables final {
+            uint64_t masks[Patterns::Regions];
+            uint16_t ternary[1U << Patterns::RegionSquares];
+
+            constexpr RegionTables() : masks(), ternary() {
+                int region = 0;
+                for(int r0 = 0; r0 <= 4; r0 += 2)
+                    for(int f0 = 0; f0 <= 4; f0 += 2) {
+                        uint64_t m = 0;
+                        for(int r = r0; r < r0 + 4; ++r)
+                            for(int f = f0; f < f0 + 4; ++f)
+                                if((r + f) & 1)
+                                    m |= SquareToBitBoard[(r << 3) + f];
+                        masks[region++] = m;
+                    }
+                constexpr int N = Patterns::RegionSquares;
+                for(unsigned int x = 0; x < 1U << N; ++x) {
+                    unsigned int t = 0, p = 1;
+                    for(int i = 0; i < N; ++i, p *= 3)
+                        if(x & (1U << i)) t += p;
+                    ternary[x] = (uint16_t) t;
+                }
+            }
+        };
+
+        /** The region tables. */
+        constexpr RegionTables Tables;
+
+        /**
+         * A method to gather the bits of the given bitboard
+         * selected by the given mask into the low bits of the
+         * result, in order.
+         *
+         * @param b the bitboard to gather from
+         * @param mask the bits to gather
+         * @return the gathered bits
+         */
+        inline uint64_t extract(const uint64_t b, uint64_t mask) {
+#if defined(__BMI2__)
+            return _pext_u64(b, mask);
+#else
+            uint64_t r = 0;
+            for(uint64_t bit = 1; mask; mask &= mask - 1, bit <<= 1U)
+                if(b & mask & (uint64_t)-(int64_t)mask) r |= bit;
+            return r;
+#endif
+        }
+
+        /**
+         * A method to compute the configuration of a region.
+         *
+         * @param white the White pieces
+         * @param black the Black pieces
+         * @param region the region to look at
+         * @return the index of the configuration
+         */
+        inline int indexOf(const uint64_t white, const uint64_t black,
+                           const int region) {
+            const uint64_t m = Tables.masks[region];
+            return Tables.ternary[extract(white, m)] +
+                   2 * Tables.ternary[extract(black, m)];
+        }
+
+        /**
+         * The header of a weight file.
+         *
+         * @struct PatternHeader
+         */
+        struct PatternHeader final {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t regions;
+            uint32_t configurations;
+        };
+    }
+
+    Patterns::Patterns() :
+            weights(),
+            ready(false)
+    {  }
+
+    bool Patterns::load(const char* const path) {
+        ready = false;
+        std::ifstream in(path, std::ios::binary);
+        PatternHeader h{};
+        if(!in.read((char*) &h, sizeof(h)) ||
+           h.magic != Magic || h.version != Version ||
+           h.regions != Regions || h.configurations != Configurations)
+            return false;
+        if(!in.read((char*) weights, sizeof(weights))) return false;
+        ready = true;
+        return true;
+    }
+
+    bool Patterns::save(const char* const path) const {
+        std::ofstream out(path, std::ios::binary);
+        const PatternHeader h { Magic, Version, Regions, Configurations };
+        out.write((const char*) &h, sizeof(h));
+        out.write((const char*) weights, sizeof(weights));
+        return (bool) out;
+    }
+
+    int Patterns::index(const Board& b, const int region) {
+        return indexOf(b.getPieces<White>(),
+                       b.getPieces<Black>(), region);
+    }
+
+    int Patterns::evaluate(const Board& b) const {
+        const uint64_t white = b.getPieces<White>(),
+                       black = b.getPieces<Black>();
+        int v = 0;
+        for(int r = 0; r < Regions; ++r)
+            v += weights[r][indexOf(white, black, r)];
+        return v;
+    }
+}
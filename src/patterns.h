@@ -0,0 +1,148 @@
+#ifndef BITCHECKERS_PATTERNS_H
+#define BITCHECKERS_PATTERNS_H
+
+#include <cstdint>
+#include "board.h"
+
+namespace checkers::opponent {
+    using namespace utility;
+
+    /**
+     * <summary>
+     *  <p>
+     * A pattern evaluation, which scores the configuration of
+     * pieces in each of several overlapping regions of the
+     * board with a lookup table.
+     *  </p>
+     *  <p>
+     * The regions are the nine 4x4 blocks whose corners lie
+     * on even ranks and files; each holds eight playable
+     * squares. Each square is empty, White or Black, so a
+     * region has 3^8 configurations. The bits of each
+     * alliance in a region are gathered with PEXT (or a
+     * software equivalent) and turned into a ternary index
+     * with a table, so a region costs two extractions and
+     * three table loads.
+     *  </p>
+     *  <p>
+     * The weight file holds the magic number, the version,
+     * the number of regions and the number of configurations
+     * of a region, each as a 32-bit integer, followed by the
+     * 16-bit weights of each configuration of each region, in
+     * order, all little-endian. Weights are from White's
+     * point of view.
+     *  </p>
+     * </summary>
+     *
+     * @class Patterns
+     */
+    class Patterns final {
+    public:
+
+        /** The magic number at the start of a weight file. */
+        static constexpr uint32_t Magic = 0x54504342; // "BCPT"
+
+        /** The version of the weight file format. */
+        static constexpr uint32_t Version = 1;
+
+        /** The number of regions. */
+        static constexpr int Regions = 9;
+
+        /** The number of squares in a region. */
+        static constexpr int RegionSquares = 8;
+
+        /** The number of configurations of a region. */
+        static constexpr int Configurations = 6561;
+
+    private:
+
+        /**
+         * @private
+         * The weight of each configuration of each region.
+         */
+        int16_t weights[Regions][Configurations];
+
+        /**
+         * @private
+         * Whether or not weights have been loaded.
+         */
+        bool ready;
+
+    public:
+
+        /** A default constructor for Patterns with no weights. */
+        Patterns();
+
+        /**
+         * A method to read a weight file, replacing the
+         * current weights.
+         *
+         * @param path the path of the weight file
+         * @return whether or not the file was a valid weight
+         * file; if not, no weights are loaded
+         */
+        bool load(const char* path);
+
+        /**
+         * A method to write the current weights to a file.
+         *
+         * @param path the path of the weight file
+         * @return whether or not the file was written
+         */
+        bool save(const char* path) const;
+
+        /**
+         * A method to check whether weights are loaded.
+         *
+         * @return whether or not weights are loaded
+         */
+        [[nodiscard]]
+        constexpr bool loaded() const { return ready; }
+
+        /**
+         * A method to replace a single weight, marking the
+         * weights as loaded.
+         *
+         * @param region the region of the weight
+         * @param index the configuration of the weight
+         * @param w the new weight
+         */
+        constexpr void
+        setWeight(const int region, const int index, const int16_t w)
+        { weights[region][index] = w; ready = true; }
+
+        /**
+         * A method to expose a single weight.
+         *
+         * @param region the region of the weight
+         * @param index the configuration of the weight
+         * @return the weight
+         */
+        [[nodiscard]]
+        constexpr int weight(const int region, const int index) const
+        { return weights[region][index]; }
+
+        /**
+         * A method to compute the configuration of a region.
+         *
+         * @param b the board to look at
+         * @param region the region to look at
+         * @return the index of the configuration of the region
+         */
+        [[nodiscard]]
+        static int index(const Board& b, int region);
+
+        /**
+         * A method to evaluate the given board from White's
+         * point of view.
+         *
+         * @param b the board to evaluate
+         * @return the sum of the weights of the configurations
+         * of every region
+         */
+        [[nodiscard]]
+        int evaluate(const Board& b) const;
+    };
+}
+
+#endif //BITCHECKERS_PATTERNS_H
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <array>
+#include <fcntl.h>
+#include <optional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pdn.h"
+#include "fen.h"
+#include "movegen.h"
+
+namespace checkers::pdn {
+    namespace {
+
+        /** The standard start, with Black to move. */
+        constexpr std::string_view StandardStart = "B:W21-32:B1-12";
+
+        /** The classes of a character, as bits. */
+        enum CharClass : uint8_t { Space = 1, Delimiter = 2 };
+
+        /**
+         * The classes of every character, white space and the
+         * characters that end a token of move text, looked up
+         * rather than compared as the text is scanned.
+         */
+        constexpr std::array<uint8_t, 256> CharClasses = [] {
+            std::array<uint8_t, 256> t {};
+            for(const char c: std::string_view(" \n\r\t\f\v"))
+                t[(unsigned char) c] = Space | Delimiter;
+            for(const char c: std::string_view("[{();"))
+                t[(unsigned char) c] = Delimiter;
+            return t;
+        }();
+
+        /**
+         * A method to tell whether or not a character is
+         * white space.
+         *
+         * @param c the character
+         * @return whether or not it is white space
+         */
+        constexpr bool isSpace(const char c)
+        { return CharClasses[(unsigned char) c] & Space; }
+
+        /**
+         * A method to tell whether or not a character ends a
+         * token of move text.
+         *
+         * @param c the character
+         * @return whether or not it ends a token
+         */
+        constexpr bool endsToken(const char c)
+        { return CharClasses[(unsigned char) c] & Delimiter; }
+
+        /**
+         * A method to read the squares of a move, such as
+         * "9x18x27".
+         *
+         * @param t the move
+         * @param squares the squares to fill, at least
+         * MaxMoveSteps + 1
+         * @return the number of squares, or zero if the token
+         * is not a move
+         */
+        int readSquares(const std::string_view t, int* const squares) {
+            int n = 0;
+            size_t i = 0;
+            while(n <= MaxMoveSteps) {
+                int number = 0;
+                const size_t first = i;
+                while(i < t.size() && t[i] >= '0' && t[i] <= '9' &&
+                      i - first < 2)
+                    number = number * 10 + (t[i++] - '0');
+                if(i == first || number < 1 || number > 32) return 0;
+                squares[n++] = numberToSquare(number);
+                if(i == t.size()) break;
+                if(t[i] != '-' && t[i] != 'x' && t[i] != 'X') return 0;
+                ++i;
+            }
+            return n >= 2 && i == t.size()? n: 0;
+        }
+
+        /**
+         * A method to replay a move whose every landing square
+         * is given, one step at a time.
+         *
+         * @param b the board to move on
+         * @param squares the squares of the move
+         * @param n the number of squares
+         * @param moves the steps to fill
+         * @param states the states of the steps
+         * @return whether or not the squares make up a whole
+         * legal move; if not, the board is left as it was
+         */
+        bool replayGiven(Board& b, const int* const squares, const int n,
+                         Move* const moves, State* const states) {
+            int i = 0;
+            for(; i + 1 < n && (!i || b.getJumper()); ++i) {
+                Move legal[movegen::MaxMoves];
+                Move* const end = movegen::generate<All>(legal, &b);
+                Move* m = legal;
+                while(m < end && (m->origin() != squares[i] ||
+                                  m->destination() != squares[i + 1]))
+                    ++m;
+                if(m == end) break;
+                moves[i] = *m;
+                b.applyMove(*m, states[i]);
+            }
+            if(i + 1 == n && !b.getJumper()) return true;
+            while(i) b.retractMove(moves[--i]);
+            return false;
+        }
+    }
+
+    std::string_view Game::tag(const std::string_view name) const {
+        for(int i = 0; i < tagCount; ++i)
+            if(tags[i].name == name) return tags[i].value;
+        return {};
+    }
+
+    Reader::Reader() :
+            states(MaxGameSteps + 1),
+            steps(MaxGameSteps),
+            games(0),
+            illegalGames(0)
+    {  }
+
+    size_t Reader::parse(const char* const data, const size_t size,
+                         const uint64_t offset, const bool last,
+                         const Callback& f) {
+        const char* const end = data + size;
+        const char* p = data;
+        size_t consumed = 0;
+
+        // The current game, which has begun once it has a tag
+        // or a token of move text.
+        const char* gameStart = nullptr;
+        std::optional<Board> start, b;
+        int used = 0;
+        bool legal = true;
+
+        const auto setUp = [&] {
+            Board::Builder builder(states[0]);
+            std::string_view fen = StandardStart;
+            for(const Tag& t: tags)
+                if(t.name == "FEN") fen = t.value;
+            if(!parseFen(fen, builder)) {
+                legal = false;
+                parseFen(StandardStart, builder);
+            }
+            start.emplace(builder.build());
+            b.emplace(*start);
+        };
+        const auto finish = [&](const int points) {
+            if(!start) setUp();
+            const Game g { tags.data(), (int) tags.size(), &*start,
+                           steps.data(), used, &*b, legal, points,
+                           offset + (uint64_t) (gameStart - data) };
+            ++games;
+            illegalGames += !legal;
+            f(g);
+            gameStart = nullptr;
+            tags.clear();
+            start.reset();
+            b.reset();
+            used = 0;
+            legal = true;
+            consumed = (size_t) (p - data);
+        };
+
+        tags.clear();
+        for(;;) {
+            while(p < end && isSpace(*p)) ++p;
+            if(p == end) break;
+            const char* const token = p;
+            if(*p == '[') {
+                // A tag after move text begins the next game.
+                if(start) finish(-1);
+                const char* q = p + 1;
+                while(q < end && isSpace(*q)) ++q;
+                const char* const name = q;
+                while(q < end && !isSpace(*q) && *q != '"' && *q != ']')
+                    ++q;
+                const std::string_view tagName(name, (size_t) (q - name));
+                while(q < end && isSpace(*q)) ++q;
+                std::string_view value;
+                if(q < end && *q == '"') {
+                    const char* const v = ++q;
+                    while(q < end && *q != '"') q += *q == '\\'? 2: 1;
+                    if(q >= end) break;
+                    value = std::string_view(v, (size_t) (q - v));
+                }
+                while(q < end && *q != ']') ++q;
+                if(q == end) break;
+                if(!gameStart) gameStart = token;
+                tags.push_back({ tagName, value });
+                p = q + 1;
+            } else if(*p == '{') {
+                const char* q = p;
+                while(q < end && *q != '}') ++q;
+                if(q == end) break;
+                p = q + 1;
+            } else if(*p == '(') {
+                const char* q = p;
+                for(int depth = 0; q < end; ++q) {
+                    if(*q == '{')
+                        while(q + 1 < end && *q != '}') ++q;
+                    depth += (*q == '(') - (*q == ')');
+                    if(!depth) break;
+                }
+                if(q == end) break;
+                p = q + 1;
+            } else if(*p == ';') {
+                while(p < end && *p != '\n') ++p;
+            } else if(*p == ')' || *p == ']' || *p == '}') {
+                ++p;
+            } else {
+                while(p < end && !endsToken(*p)) ++p;
+                // A token may go on in the next block.
+                if(p == end && !last) break;
+                std::string_view t(token, (size_t) (p - token));
+                if(!gameStart) gameStart = token;
+                if(const int points = parseResult(t); points != NoResult) {
+                    finish(points);
+                    continue;
+                }
+                if(!start) setUp();
+                // Move numbers may run into the move, as in
+                // "1.11-15", and marks of strength may follow it.
+                if(const size_t dot = t.rfind('.');
+                   dot != std::string_view::npos)
+                    t.remove_prefix(dot + 1);
+                while(!t.empty() && (t.back() == '!' || t.back() == '?'))
+                    t.remove_suffix(1);
+                if(t.empty() || t.front() == '$' || !legal) continue;
+
+                int squares[MaxMoveSteps + 1];
+                const int n = readSquares(t, squares);
+                if(!n || used + MaxMoveSteps > MaxGameSteps) {
+                    legal = false;
+                    continue;
+                }
+                if(replayGiven(*b, squares, n, &steps[used],
+                               &states[used + 1])) {
+                    used += n - 1;
+                    continue;
+                }
+                // Some landing squares are left out.
+                Move found[MaxMoveSteps];
+                const int k = parseMove(t, *b, found);
+                legal = k > 0;
+                for(int i = 0; i < k; ++i) {
+                    steps[used] = found[i];
+                    b->applyMove(found[i], states[++used]);
+                }
+            }
+        }
+        if(last && gameStart) {
+            p = end;
+            finish(-1);
+        }
+        return last? size: consumed;
+    }
+
+    bool Reader::readFile(const std::string& path, const Callback& f) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st{};
+        const auto size = (size_t) (fstat(fd, &st) == 0? st.st_size: 0);
+        if(!size) {
+            ::close(fd);
+            return true;
+        }
+        void* const mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE,
+                                   fd, 0);
+        ::close(fd);
+        if(mapping == MAP_FAILED) return false;
+        // The file is read once, front to back.
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        parse((const char*) mapping, size, 0, true, f);
+        munmap(mapping, size);
+        return true;
+    }
+
+    bool Reader::readStream(std::istream& in, const Callback& f) {
+        std::vector<char> buffer(ChunkSize);
+        size_t filled = 0;
+        uint64_t offset = 0;
+        for(bool more = true; more;) {
+            // A game longer than the buffer doubles it.
+            if(filled == buffer.size()) buffer.resize(buffer.size() * 2);
+            in.read(buffer.data() + filled,
+                    (std::streamsize) (buffer.size() - filled));
+            filled += (size_t) in.gcount();
+            more = (bool) in;
+            const size_t taken = parse(buffer.data(), filled, offset,
+                                       !more, f);
+            std::copy(buffer.begin() + (std::ptrdiff_t) taken,
+                      buffer.begin() + (std::ptrdiff_t) filled,
+                      buffer.begin());
+            filled -= taken;
+            offset += taken;
+        }
+        return in.eof();
+    }
+}
@@ -0,0 +1,210 @@
+#ifndef BITCHECKERS_PDN_H
+#define BITCHECKERS_PDN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "board.h"
+
+namespace checkers::pdn {
+    using namespace utility;
+
+    /** The most steps of a game that are replayed. */
+    constexpr int MaxGameSteps = 1024;
+
+    /**
+     * <summary>
+     * A tag pair of a game, such as [Event "..."].
+     * </summary>
+     *
+     * @struct Tag
+     */
+    struct Tag final {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    /**
+     * <summary>
+     * A game as it is handed to a callback. The views and
+     * pointers are valid only during the call.
+     * </summary>
+     *
+     * @struct Game
+     */
+    struct Game final {
+
+        /** The tag pairs of the game, in order. */
+        const Tag* tags;
+        int tagCount;
+
+        /**
+         * The position the game starts from: that of the FEN
+         * tag if there is one, otherwise the standard start
+         * with Black to move.
+         */
+        const Board* start;
+
+        /**
+         * The steps replayed, one for each jump of a
+         * multi-jump, up to the first move that could not be.
+         */
+        const Move* steps;
+        int stepCount;
+
+        /** The position after the steps replayed. */
+        const Board* end;
+
+        /**
+         * Whether or not every move was replayed; if not, the
+         * game stops at the first move that is not legal, or
+         * has a FEN that cannot be read, or is too long.
+         */
+        bool legal;
+
+        /**
+         * The first number of the result, which stands for the
+         * player to move at the start, in half points: 2 for a
+         * win, 1 for a draw, 0 for a loss, or -1 if the result
+         * is "*" or missing.
+         */
+        int points;
+
+        /** The offset of the game from the start of the input. */
+        uint64_t offset;
+
+        /**
+         * A method to find the value of a tag.
+         *
+         * @param name the name of the tag
+         * @return the value, or an empty view if there is none
+         */
+        [[nodiscard]]
+        std::string_view tag(std::string_view name) const;
+    };
+
+    /**
+     * <summary>
+     *  <p>
+     * A streaming reader of PDN game records. Input is read a
+     * chunk at a time, or mapped into memory, and tokenized in
+     * place: tag pairs, comments, variations, move numbers,
+     * move strength marks and results are recognized, and each
+     * move is matched against the legal moves of the current
+     * position and replayed. A callback is called for each
+     * game as soon as it ends, so that no more than a game and
+     * a chunk are ever held at once.
+     *  </p>
+     *  <p>
+     * A move whose every square is given is matched step by
+     * step against the move generator; one with landing squares
+     * left out, such as "9x27", is searched for as parseMove
+     * does.
+     *  </p>
+     * </summary>
+     *
+     * @class Reader
+     */
+    class Reader final {
+    public:
+
+        /** The type of the callback of each game. */
+        using Callback = std::function<void(const Game&)>;
+
+        /** The size of each chunk read from a stream. */
+        static constexpr size_t ChunkSize = 1 << 20;
+
+    private:
+
+        /**
+         * @private
+         * The states of the steps of the current game, the
+         * first that of its start.
+         */
+        std::vector<State> states;
+
+        /**
+         * @private
+         * The steps and tags of the current game.
+         */
+        std::vector<Move> steps;
+        std::vector<Tag> tags;
+
+        /**
+         * @private
+         * The number of games read and of those not replayed
+         * in full.
+         */
+        uint64_t games;
+        uint64_t illegalGames;
+
+        /**
+         * @private
+         * A method to read the games that end within a block
+         * of text.
+         *
+         * @param data the text
+         * @param size the length of the text
+         * @param offset the offset of the text in the input
+         * @param last whether or not the text ends the input,
+         * so that a game cut short at its end is read as well
+         * @param f the callback
+         * @return the length of the text taken up by the games
+         * read, from which the next block must start
+         */
+        size_t parse(const char* data, size_t size, uint64_t offset,
+                     bool last, const Callback& f);
+
+    public:
+
+        /** A default constructor for a Reader. */
+        Reader();
+
+        /** @public Deleted copy constructor. */
+        Reader(const Reader&) = delete;
+
+        /**
+         * A method to read every game of a file, mapped into
+         * memory.
+         *
+         * @param path the path of the file
+         * @param f the callback
+         * @return whether or not the file could be read
+         */
+        bool readFile(const std::string& path, const Callback& f);
+
+        /**
+         * A method to read every game of a stream, a chunk at
+         * a time.
+         *
+         * @param in the stream
+         * @param f the callback
+         * @return whether or not the stream was read to its end
+         */
+        bool readStream(std::istream& in, const Callback& f);
+
+        /**
+         * A method to expose the number of games read.
+         *
+         * @return the number of games read
+         */
+        [[nodiscard]]
+        constexpr uint64_t gameCount() const { return games; }
+
+        /**
+         * A method to expose the number of games not replayed
+         * in full.
+         *
+         * @return the number of games with a move that is not
+         * legal
+         */
+        [[nodiscard]]
+        constexpr uint64_t illegalCount() const { return illegalGames; }
+    };
+}
+
+#endif //BITCHECKERS_PDN_H
@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <sstream>
+#include "protocol.h"
+#include "fen.h"
+#include "movegen.h"
+
+namespace checkers::opponent {
+    namespace {
+
+        /**
+         * The depth of the search for the rest of a multi-jump
+         * that the principal variation does not hold.
+         */
+        constexpr int CompletionDepth = 6;
+
+        /** The most threads of an engine. */
+        constexpr int MaxThreads = 256;
+
+        /** The size of the evaluation cache, in megabytes. */
+        constexpr size_t EvalCacheMegabytes = 1;
+
+        /**
+         * The number of depths the first iterations of the
+         * helpers are spread over.
+         */
+        constexpr int HelperDepths = 4;
+    }
+
+    int completeMove(Search& s, const Board& b, const Move first,
+                     const PvLine& line, Move* const steps) {
+        Board c = b;
+        State states[MaxMoveSteps];
+        int n = 0;
+        bool follow = line.length && line.moves[0] == first;
+        steps[n] = first;
+        c.applyMove(first, states[n++]);
+        while(c.getJumper() && n < MaxMoveSteps) {
+            Move legal[movegen::MaxMoves];
+            Move* const end = movegen::generate<All>(legal, &c);
+            follow = follow && n < line.length &&
+                     std::find(legal, end, line.moves[n]) != end;
+            Move next = follow? line.moves[n]: legal[0];
+            if(!follow && end - legal > 1) {
+                SearchLimits l;
+                l.depth = CompletionDepth;
+                s.setBoard(c);
+                s.clearSignals();
+                const Move m = s.think(l);
+                if(m != NullMove) next = m;
+            }
+            steps[n] = next;
+            c.applyMove(next, states[n++]);
+        }
+        return n;
+    }
+
+    std::string variationText(const Board& b, const Move* const moves,
+                              const int n) {
+        Board c = b;
+        State states[MaxPly];
+        std::string text;
+        for(int i = 0; i < n && i < MaxPly;) {
+            const int first = i;
+            do c.applyMove(moves[i], states[i]);
+            while(++i < n && i < MaxPly && c.getJumper());
+            if(!text.empty()) text.push_back(' ');
+            text.append(toMoveText(moves + first, i - first));
+        }
+        return text;
+    }
+
+    Engine::Engine(std::ostream& out) :
+            out(out),
+            tt(16),
+            evalCache(EvalCacheMegabytes),
+            statsBuffer(*this),
+            statsOut(&statsBuffer),
+            showStats(false),
+            network(nullptr),
+            patterns(nullptr),
+            database(nullptr),
+            openingBook(nullptr),
+            board(Board::Builder(rootState).build()),
+            released(false),
+            unbounded(false),
+            random(std::random_device()())
+    { setThreads(1); }
+
+    Engine::~Engine()
+    { stop(); }
+
+    void Engine::reply(const std::string& line) {
+        std::lock_guard<std::mutex> g(outLock);
+        out << line << std::endl;
+    }
+
+    int Engine::InfoBuffer::overflow(const int c) {
+        if(c == '\n') {
+            engine.reply("info string " + line);
+            line.clear();
+        } else if(c != traits_type::eof()) line.push_back((char) c);
+        return traits_type::not_eof(c);
+    }
+
+    void Engine::configure(Search& s) {
+        s.setNetwork(network);
+        s.setPatterns(patterns);
+        s.setEvalCache(&evalCache);
+        s.setEndgameDatabase(database);
+        s.setOptions(options);
+        s.setStatisticsOutput(showStats && &s == searches[0].get()?
+                              &statsOut: nullptr);
+    }
+
+    void Engine::setThreads(const int n) {
+        finish();
+        searches.resize(std::clamp(n, 1, MaxThreads));
+        for(size_t i = 0; i < searches.size(); ++i)
+            if(!searches[i]) {
+                searches[i] = std::make_unique<Search>(board, tt);
+                searches[i]->setFirstDepth(1 + (int) i % HelperDepths);
+                configure(*searches[i]);
+            }
+    }
+
+    void Engine::setEvaluation(const Network* const n,
+                               const Patterns* const p) {
+        finish();
+        network = n;
+        patterns = p;
+        evalCache.clear();
+        for(std::unique_ptr<Search>& s: searches) configure(*s);
+    }
+
+    void Engine::setEndgameDatabase(const egdb::Database* const d) {
+        finish();
+        database = d;
+        for(std::unique_ptr<Search>& s: searches) configure(*s);
+    }
+
+    void Engine::setBook(const book::Book* const b)
+    { openingBook = b; }
+
+    void Engine::release() {
+        {
+            std::lock_guard<std::mutex> g(holdLock);
+            released = true;
+        }
+        holdSignal.notify_all();
+    }
+
+    void Engine::stop() {
+        for(std::unique_ptr<Search>& s: searches) s->requestStop();
+        release();
+        if(supervisor.joinable()) supervisor.join();
+    }
+
+    void Engine::finish() {
+        if(unbounded) stop();
+        else if(supervisor.joinable()) supervisor.join();
+    }
+
+    bool Engine::setPosition(std::istream& args) {
+        std::string kind, token;
+        args >> kind;
+        Board::Builder b(rootState);
+        bool legal = kind == "start" ||
+                     (kind == "fen" && args >> token && parseFen(token, b));
+        moveStates.clear();
+        board = legal? b.build(): Board::Builder(rootState).build();
+        if(legal && args >> token) legal = token == "moves";
+        while(legal && args >> token) {
+            Move steps[MaxMoveSteps];
+            const int n = parseMove(token, board, steps);
+            legal = n > 0;
+            for(int i = 0; i < n; ++i)
+                board.applyMove(steps[i], moveStates.emplace_back());
+        }
+        return legal;
+    }
+
+    void Engine::go(std::istream& args) {
+        finish();
+        SearchLimits l;
+        for(std::string token; args >> token;) {
+            if(token == "infinite") l.infinite = true;
+            else if(token == "ponder") l.ponder = true;
+            else {
+                int64_t v = 0;
+                args >> v;
+                if(token == "depth")
+                    l.depth = (int) std::max<int64_t>(1, v);
+                else if(token == "nodes")
+                    l.nodes = (uint64_t) std::max<int64_t>(0, v);
+                else if(token == "movetime") l.moveTime = v;
+                else if(token == "wtime") l.time[White] = v;
+                else if(token == "btime") l.time[Black] = v;
+                else if(token == "winc") l.increment[White] = v;
+                else if(token == "binc") l.increment[Black] = v;
+                else if(token == "movestogo") l.movesToGo = (int) v;
+            }
+        }
+
+        // A move of the book is played at once, jump by jump,
+        // any jumps the book lacks taken from a short search.
+        if(openingBook && !l.infinite && !l.ponder) {
+            Board b = board;
+            State states[MaxMoveSteps];
+            Move steps[MaxMoveSteps];
+            int n = 0;
+            for(Move m; n < MaxMoveSteps && (n == 0 || b.getJumper()) &&
+                (m = openingBook->pick(b, random())) != NullMove; ++n) {
+                steps[n] = m;
+                b.applyMove(m, states[n]);
+            }
+            if(n && b.getJumper()) {
+                Board before = board;
+                State s[MaxMoveSteps];
+                for(int i = 0; i < n - 1; ++i)
+                    before.applyMove(steps[i], s[i]);
+                n = n - 1 + completeMove(*searches[0], before,
+                        steps[n - 1], PvLine(), steps + n - 1);
+            }
+            if(n) {
+                reply("info book");
+                reply("bestmove " + toMoveText(steps, n));
+                return;
+            }
+        }
+
+        // The table is aged once for the move, not once for
+        // each thread searching it.
+        tt.newSearch();
+        for(std::unique_ptr<Search>& s: searches) {
+            s->setBoard(board);
+            s->clearSignals();
+        }
+        released = false;
+        unbounded = l.infinite || l.ponder;
+        supervisor = std::thread(&Engine::run, this, l);
+    }
+
+    void Engine::run(const SearchLimits l) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> helpers;
+        for(size_t i = 1; i < searches.size(); ++i)
+            helpers.emplace_back([this, i, l] { searches[i]->think(l); });
+        Search& main = *searches[0];
+        const Move best = main.think(l);
+        for(size_t i = 1; i < searches.size(); ++i)
+            searches[i]->requestStop();
+        for(std::thread& th: helpers) th.join();
+
+        // An infinite or pondering search may not move until
+        // told to.
+        if(l.infinite || main.isPondering()) {
+            std::unique_lock<std::mutex> g(holdLock);
+            holdSignal.wait(g, [this] { return released; });
+        }
+
+        const PvLine line = main.line(0);
+        const Move ponder = main.ponderMove();
+        uint64_t nodes = 0;
+        for(const std::unique_ptr<Search>& s: searches)
+            nodes += s->nodeCount();
+        const auto time = std::chrono::duration_cast
+                <std::chrono::milliseconds>
+                (std::chrono::steady_clock::now() - start).count();
+        std::ostringstream info;
+        info << "info depth " << line.depth << " score " << line.score
+             << " nodes " << nodes << " time " << time;
+        if(line.length)
+            info << " pv " << variationText(board, line.moves, line.length);
+        reply(info.str());
+        if(best == NullMove) {
+            reply("bestmove none");
+            return;
+        }
+
+        Move steps[MaxMoveSteps];
+        const int n = completeMove(main, board, best, line, steps);
+        std::string text = "bestmove " + toMoveText(steps, n);
+        // The search has a reply only if the variation holds
+        // the whole of our turn, which is then the move played.
+        if(ponder != NullMove) {
+            Board after = board;
+            State states[MaxMoveSteps];
+            for(int i = 0; i < line.turn; ++i)
+                after.applyMove(line.moves[i], states[i]);
+            const std::string rest = variationText(after,
+                    line.moves + line.turn, line.length - line.turn);
+            text += " ponder " + rest.substr(0, rest.find(' '));
+        }
+        reply(text);
+    }
+
+    void Engine::setOption(std::istream& args) {
+        std::string name;
+        int64_t value = 0;
+        args >> name >> value;
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](const char c) { return (char) std::tolower(c); });
+        if(name == "hash") {
+            finish();
+            tt.resize((size_t) std::max<int64_t>(1, value));
+        } else if(name == "threads") setThreads((int) value);
+        else if(name == "multipv") {
+            finish();
+            options.multiPV =
+                    (int) std::clamp<int64_t>(value, 1, MaxMultiPV);
+            for(std::unique_ptr<Search>& s: searches) configure(*s);
+        } else if(name == "stats") {
+            finish();
+            showStats = value != 0;
+            configure(*searches[0]);
+        } else reply("info string unknown option " + name);
+    }
+
+    bool Engine::execute(const std::string& line) {
+        std::istringstream args(line);
+        std::string command;
+        if(!(args >> command)) return true;
+        if(command == "isready") reply("readyok");
+        else if(command == "newgame") {
+            finish();
+            tt.clear();
+            evalCache.clear();
+        } else if(command == "position") {
+            finish();
+            if(!setPosition(args)) reply("info string illegal position");
+        } else if(command == "go") go(args);
+        else if(command == "stop") stop();
+        else if(command == "ponderhit") {
+            unbounded = false;
+            for(std::unique_ptr<Search>& s: searches) s->ponderhit();
+            release();
+        } else if(command == "setoption") setOption(args);
+        else if(command == "quit") {
+            stop();
+            return false;
+        } else reply("info string unknown command " + command);
+        return true;
+    }
+
+    void Engine::loop(std::istream& in) {
+        for(std::string line; std::getline(in, line);)
+            if(!execute(line)) return;
+        finish();
+    }
+}
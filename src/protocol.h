@@ -0,0 +1,360 @@
+#ifndef BITCHECKERS_PROTOCOL_H
+#define BITCHECKERS_PROTOCOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "opponent.h"
+#include "book.h"
+
+namespace checkers::opponent {
+
+    /**
+     * A method to find every step of a move that starts with
+     * the given step, taking the rest from a principal
+     * variation where it has them, and otherwise from a short
+     * search.
+     *
+     * @param s the search to use for the steps the variation
+     * lacks, which must not be running
+     * @param b the board to move from
+     * @param first the first step
+     * @param line the variation, which may start with the
+     * first step
+     * @param steps the steps to fill, at least MaxMoveSteps
+     * @return the number of steps filled
+     */
+    int completeMove(Search& s, const Board& b, Move first,
+                     const PvLine& line, Move* steps);
+
+    /**
+     * A method to write a sequence of steps in standard
+     * notation, joining the steps of each multi-jump into a
+     * single move.
+     *
+     * @param b the board the steps start from
+     * @param moves the steps
+     * @param n the number of steps
+     * @return the moves, separated by spaces
+     */
+    std::string variationText(const Board& b, const Move* moves, int n);
+
+    /**
+     * <summary>
+     *  <p>
+     * An engine driven by text commands, one per line, which
+     * searches on its own threads so that it can take commands
+     * while it thinks. A "stop" ends the search at its next
+     * poll, after which the best move is sent at once. Any
+     * other command that changes the engine waits for a search
+     * with limits to end first.
+     *  </p>
+     *  <p>
+     * The commands are:
+     *  </p>
+     *  <ul>
+     *   <li>"isready", answered with "readyok" once every
+     *   command before it has been carried out;</li>
+     *   <li>"newgame", to clear the tables;</li>
+     *   <li>"position start|fen &lt;fen&gt; [moves &lt;move&gt;...]",
+     *   the moves in standard notation;</li>
+     *   <li>"go" with any of "depth", "nodes", "movetime",
+     *   "wtime", "btime", "winc", "binc", "movestogo", each
+     *   with a number, and "infinite" and "ponder";</li>
+     *   <li>"stop" and "ponderhit";</li>
+     *   <li>"setoption &lt;name&gt; &lt;value&gt;", the names
+     *   being "hash" in megabytes, "threads", "multipv" and
+     *   "stats", nonzero to report the statistics of the
+     *   first thread after each iteration as an "info string
+     *   stats" line;</li>
+     *   <li>"quit".</li>
+     *  </ul>
+     *  <p>
+     * A search ends with "info" and its depth, score, nodes,
+     * time in milliseconds and principal variation, then
+     * "bestmove" with the whole move, every jump of it, and
+     * "ponder" with the expected reply if there is one. An
+     * infinite or pondering search holds its best move until
+     * "stop" or "ponderhit".
+     *  </p>
+     *  <p>
+     * With more than one thread, the helpers search the same
+     * position on the shared transposition table, each from a
+     * different first depth, and only the first thread's
+     * result is reported.
+     *  </p>
+     * </summary>
+     *
+     * @class Engine
+     */
+    class Engine final {
+    private:
+
+        /**
+         * <summary>
+         * A stream buffer that passes each line written to it
+         * to the replies of an engine, as "info string".
+         * </summary>
+         *
+         * @struct InfoBuffer
+         */
+        struct InfoBuffer final : std::streambuf {
+            Engine& engine;
+            std::string line;
+
+            explicit InfoBuffer(Engine& e) : engine(e) {}
+
+            int overflow(int c) override;
+        };
+
+        /**
+         * @private
+         * The stream the replies are written to.
+         */
+        std::ostream& out;
+
+        /**
+         * @private
+         * A lock on the stream, which the search threads share
+         * with the thread reading commands.
+         */
+        std::mutex outLock;
+
+        /**
+         * @private
+         * The transposition table of every search.
+         */
+        TranspositionTable tt;
+
+        /**
+         * @private
+         * The evaluation cache of every search.
+         */
+        EvalCache evalCache;
+
+        /**
+         * @private
+         * The searches, the first reporting and the rest
+         * helping it.
+         */
+        std::vector<std::unique_ptr<Search>> searches;
+
+        /**
+         * @private
+         * The options of every search.
+         */
+        SearchOptions options;
+
+        /**
+         * @private
+         * The stream the first search prints its statistics
+         * to, and whether or not it does.
+         */
+        InfoBuffer statsBuffer;
+        std::ostream statsOut;
+        bool showStats;
+
+        /**
+         * @private
+         * The network, pattern weights, endgame database and
+         * opening book, or nullptr.
+         */
+        const Network* network;
+        const Patterns* patterns;
+        const egdb::Database* database;
+        const book::Book* openingBook;
+
+        /**
+         * @private
+         * The state of the position set and those of the
+         * moves played from it.
+         */
+        State rootState;
+        std::deque<State> moveStates;
+
+        /**
+         * @private
+         * The position to search.
+         */
+        Board board;
+
+        /**
+         * @private
+         * The thread running the current search, joinable
+         * while one is running or has not been collected.
+         */
+        std::thread supervisor;
+
+        /**
+         * @private
+         * The signal that releases a finished search held by
+         * an infinite or pondering limit.
+         */
+        std::mutex holdLock;
+        std::condition_variable holdSignal;
+        bool released;
+
+        /**
+         * @private
+         * Whether or not the current search is infinite or
+         * pondering, and so never ends by itself.
+         */
+        bool unbounded;
+
+        /**
+         * @private
+         * The source of the random choices among book moves.
+         */
+        std::mt19937_64 random;
+
+        /**
+         * @private
+         * A method to write a line of reply.
+         *
+         * @param line the line to write
+         */
+        void reply(const std::string& line);
+
+        /**
+         * @private
+         * A method to pass the evaluation, tables and options
+         * of this engine to a search.
+         *
+         * @param s the search to set up
+         */
+        void configure(Search& s);
+
+        /**
+         * @private
+         * A method to set the number of searches.
+         *
+         * @param n the number of threads
+         */
+        void setThreads(int n);
+
+        /**
+         * @private
+         * A method to stop the current search and wait for it
+         * to report.
+         */
+        void stop();
+
+        /**
+         * @private
+         * A method to wait for the current search to end and
+         * report, stopping it only if it would never end by
+         * itself.
+         */
+        void finish();
+
+        /**
+         * @private
+         * A method to release a search held until a stop or a
+         * ponder hit.
+         */
+        void release();
+
+        /**
+         * @private
+         * A method to carry out a "position" command.
+         *
+         * @param args the rest of the command
+         * @return whether or not the position could be set
+         */
+        bool setPosition(std::istream& args);
+
+        /**
+         * @private
+         * A method to carry out a "go" command.
+         *
+         * @param args the rest of the command
+         */
+        void go(std::istream& args);
+
+        /**
+         * @private
+         * A method to carry out a "setoption" command.
+         *
+         * @param args the rest of the command
+         */
+        void setOption(std::istream& args);
+
+        /**
+         * @private
+         * A method to run a search and report its result, on
+         * the supervisor thread.
+         *
+         * @param l the limits of the search
+         */
+        void run(SearchLimits l);
+
+    public:
+
+        /**
+         * A public constructor for an Engine, with one thread
+         * and a 16 MB transposition table.
+         *
+         * @param out the stream to write the replies to
+         */
+        explicit Engine(std::ostream& out);
+
+        /** A destructor, which stops any search. */
+        ~Engine();
+
+        /** @public Deleted copy constructor. */
+        Engine(const Engine&) = delete;
+
+        /**
+         * A method to change the evaluation.
+         *
+         * @param n the network, which must outlive this engine,
+         * or nullptr
+         * @param p the pattern weights, which must outlive this
+         * engine, or nullptr
+         */
+        void setEvaluation(const Network* n, const Patterns* p);
+
+        /**
+         * A method to change the endgame database.
+         *
+         * @param d the database, which must outlive this
+         * engine, or nullptr
+         */
+        void setEndgameDatabase(const egdb::Database* d);
+
+        /**
+         * A method to change the opening book, from which the
+         * engine plays without searching when it can.
+         *
+         * @param b the book, which must outlive this engine, or
+         * nullptr
+         */
+        void setBook(const book::Book* b);
+
+        /**
+         * A method to carry out a single command.
+         *
+         * @param line the command
+         * @return whether or not to go on reading commands
+         */
+        bool execute(const std::string& line);
+
+        /**
+         * A method to carry out commands until "quit", or the
+         * end of the input and the search it leaves running.
+         *
+         * @param in the stream to read the commands from
+         */
+        void loop(std::istream& in);
+    };
+}
+
+#endif //BITCHECKERS_PROTOCOL_H
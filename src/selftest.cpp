@@ -0,0 +1,125 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "egdb.h"
+#include "egdbcache.h"
+#include "egdbfile.h"
+
+using namespace checkers;
+using namespace checkers::egdb;
+
+/*
+ * A check of the endgame database code, which needs no
+ * solved databases. For every slice of up to the given number
+ * of pieces, it checks that the index of the position of each
+ * legal index is that index, so that the map between them is
+ * one to one. It then writes each slice as a compressed file
+ * of made-up values, maps the files back in as the engine
+ * does, and checks that every legal position probes to the
+ * value written, both decoding only as far as each probe
+ * needs and through a cache of decoded blocks.
+ *
+ * usage: selftest <scratch dir> [max pieces]
+ *
+ * The values come in runs of varied length, broken now and
+ * then by a lone value, so that every length class of the code
+ * is used. The exit status is nonzero on any mismatch.
+ */
+namespace {
+
+    /** The greatest number of pieces checked by default. */
+    constexpr int DefaultPieces = 4;
+
+    /**
+     * A method to build a board from piece bitboards.
+     *
+     * @param s the state of the board
+     * @param p the piece bitboards, by alliance and type
+     * @param side the player to move
+     * @return the board
+     */
+    Board makeBoard(State& s, const uint64_t p[2][2],
+                    const Alliance side) {
+        Board::Builder b(s);
+        b.setPieces<White, Pawn>(p[White][Pawn])
+         .setPieces<White, King>(p[White][King])
+         .setPieces<Black, Pawn>(p[Black][Pawn])
+         .setPieces<Black, King>(p[Black][King])
+         .setCurrentPlayer(side == White? 'w': 'b');
+        return b.build();
+    }
+
+    /**
+     * A method to make up the value of an index.
+     *
+     * @param i the index
+     * @return the value written for it
+     */
+    Value madeUp(const uint64_t i) {
+        const uint64_t h = i * 0x9E3779B97F4A7C15ULL;
+        if((h >> 58U) == 0) return Value(Win + (h >> 40U) % 3);
+        return Value(Win + (i >> (i >> 16U) % 12U) % 3);
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        std::cerr << "usage: " << argv[0]
+                  << " <scratch dir> [max pieces]\n";
+        return 1;
+    }
+    const std::string dir = argv[1];
+    const int pieces = argc > 2? std::atoi(argv[2]): DefaultPieces;
+    if(pieces < 2 || pieces > 8) {
+        std::cerr << "The number of pieces must be from 2 to 8\n";
+        return 1;
+    }
+
+    uint64_t legal = 0, indexErrors = 0, valueErrors = 0;
+    for(const Material& m: materials(pieces)) {
+        const Slice slice(m);
+        std::vector<uint8_t> values(slice.size(), Unknown);
+        for(uint64_t i = 0; i < slice.size(); ++i) {
+            uint64_t p[2][2];
+            Alliance side;
+            if(!slice.position(i, p, side)) continue;
+            State s;
+            const Board b = makeBoard(s, p, side);
+            indexErrors += slice.index(b) != i;
+            values[i] = madeUp(i);
+            ++legal;
+        }
+        if(!compress(dir + '/' + m.name() + ".cdb", slice, values)) {
+            std::cerr << "Cannot write " << dir << '/' << m.name()
+                      << ".cdb\n";
+            return 1;
+        }
+    }
+
+    Database db;
+    BlockCache cache(1);
+    const int files = db.open(dir, pieces);
+    for(BlockCache* const c: { (BlockCache*) nullptr, &cache }) {
+        db.setCache(c);
+        for(const Material& m: materials(pieces)) {
+            const Slice slice(m);
+            for(uint64_t i = 0; i < slice.size(); ++i) {
+                uint64_t p[2][2];
+                Alliance side;
+                if(!slice.position(i, p, side)) continue;
+                State s;
+                valueErrors += db.probe(makeBoard(s, p, side)) != madeUp(i);
+            }
+        }
+    }
+
+    std::cout << "slices " << materials(pieces).size()
+              << " mapped " << files
+              << " legal positions " << legal
+              << " index mismatches " << indexErrors
+              << " value mismatches " << valueErrors << '\n';
+    return indexErrors || valueErrors ||
+           files != (int) materials(pieces).size()? 1: 0;
+}
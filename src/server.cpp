@@ -0,0 +1,718 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "board.h"
+#include "egdbcache.h"
+#include "fen.h"
+#include "opponent.h"
+#include "protocol.h"
+
+using namespace checkers;
+using namespace checkers::opponent;
+
+/*
+ * A search server on a Unix domain socket, for local services
+ * that want many short searches without starting an engine
+ * for each. One event loop serves every client with epoll,
+ * and hands the requests it reads to a pool of search
+ * threads, each pinned to a core, which share one warm
+ * transposition table and evaluation cache.
+ *
+ * usage: server <socket> [threads] [--depth n] [--hash mb]
+ *               [--weights file] [--egdb dir]
+ *
+ * A client writes one request per line, and may send many
+ * without waiting:
+ *
+ *   <tag> <fen> [depth n] [nodes n] [movetime ms]
+ *   <tag> stats
+ *
+ * The tag, any word, is echoed in the reply so that replies,
+ * which come back as each search ends and so not always in
+ * order, can be matched to requests. A search is answered
+ * with {"tag", "move", "score", "depth", "nodes", "wait",
+ * "time"}, the times in microseconds, the first spent queued
+ * and the second in all, and "stats" with histograms of both
+ * times over every request served, bucket i counting those of
+ * less than 2^i microseconds, and with the probes and hits of
+ * the shared evaluation cache, which a build without search
+ * statistics leaves at zero. A request that cannot be read
+ * is answered with {"tag", "error"}.
+ *
+ * The requests read in one turn of the event loop are queued
+ * at once, and each search thread takes its share of them in
+ * one batch, though each reply is sent as soon as its own
+ * search ends. The shared transposition table is aged once for
+ * each round of as many requests as there are threads. The
+ * server runs until SIGINT or SIGTERM, which stops every
+ * search and leaves the rest of each batch unserved.
+ */
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /** The depth of a search that gives no limit, by default. */
+    constexpr int DefaultDepth = 8;
+
+    /** The size of the shared transposition table by default. */
+    constexpr size_t DefaultTableMegabytes = 64;
+
+    /** The size of the shared evaluation cache. */
+    constexpr size_t EvalCacheMegabytes = 16;
+
+    /** The most requests a search thread takes at a time. */
+    constexpr size_t BatchSize = 16;
+
+    /** The longest request line. */
+    constexpr size_t MaxLineLength = 4096;
+
+    /** The most events taken in one turn of the event loop. */
+    constexpr int MaxEvents = 64;
+
+    /** The number of buckets of a latency histogram. */
+    constexpr int Buckets = 32;
+
+    /**
+     * The identifiers of the descriptors of the event loop
+     * that are not clients, whose identifiers follow.
+     */
+    constexpr uint64_t ListenerId = 0, WakeId = 1, SignalId = 2,
+                       FirstClientId = 3;
+
+    /**
+     * <summary>
+     * A search asked for by a client.
+     * </summary>
+     *
+     * @struct Request
+     */
+    struct Request final {
+        uint64_t client;
+        std::string tag;
+        std::string fen;
+        SearchLimits limits;
+        Clock::time_point arrival;
+    };
+
+    /**
+     * <summary>
+     * A line to send to a client.
+     * </summary>
+     *
+     * @struct Reply
+     */
+    struct Reply final {
+        uint64_t client;
+        std::string line;
+    };
+
+    /**
+     * <summary>
+     * A connected client, with what it has sent but not yet
+     * ended with a newline, what is yet to be sent to it, and
+     * the number of its searches not yet answered. A client
+     * that has ended its side of the connection is kept until
+     * it has been answered in full.
+     * </summary>
+     *
+     * @struct Client
+     */
+    struct Client final {
+        int fd;
+        std::string in;
+        std::string out;
+        size_t pending;
+        uint32_t events;
+        bool ended;
+    };
+
+    /**
+     * <summary>
+     * A histogram of latencies, in powers of two of
+     * microseconds, which any thread may add to.
+     * </summary>
+     *
+     * @struct Histogram
+     */
+    struct Histogram final {
+        std::atomic<uint64_t> counts[Buckets]{};
+
+        void add(const uint64_t micros) {
+            int i = 0;
+            while(i < Buckets - 1 && (1ULL << i) <= micros) ++i;
+            counts[i].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::string toJson() const {
+            int last = 0;
+            for(int i = 0; i < Buckets; ++i)
+                if(counts[i].load(std::memory_order_relaxed)) last = i;
+            std::string out = "[";
+            for(int i = 0; i <= last; ++i) {
+                if(i) out.push_back(',');
+                out.append(std::to_string(
+                        counts[i].load(std::memory_order_relaxed)));
+            }
+            return out + ']';
+        }
+    };
+
+    /**
+     * A method to quote a string in JSON.
+     *
+     * @param s the string
+     * @return the quoted string
+     */
+    std::string quote(const std::string& s) {
+        std::string out = "\"";
+        for(const char c: s) {
+            if(c == '"' || c == '\\') out.push_back('\\');
+            if((unsigned char) c >= 0x20) out.push_back(c);
+        }
+        return out + '"';
+    }
+
+    /**
+     * A method to count the microseconds between two times.
+     *
+     * @param from the earlier time
+     * @param to the later time
+     * @return the microseconds between them
+     */
+    uint64_t micros(const Clock::time_point from,
+                    const Clock::time_point to) {
+        return (uint64_t) std::chrono::duration_cast
+                <std::chrono::microseconds>(to - from).count();
+    }
+
+    /**
+     * <summary>
+     * The server: the event loop, the queue of requests it
+     * fills, the search threads that empty it and the queue of
+     * replies they fill in turn.
+     * </summary>
+     *
+     * @class Server
+     */
+    class Server final {
+    private:
+        int listener, wake, signals, epoll;
+        std::unordered_map<uint64_t, Client> clients;
+        uint64_t nextClientId;
+
+        TranspositionTable tt;
+        EvalCache evalCache;
+        std::vector<std::unique_ptr<Search>> searches;
+        std::vector<std::thread> pool;
+        int defaultDepth;
+
+        std::mutex requestLock;
+        std::condition_variable requestReady;
+        std::deque<Request> requests;
+        uint64_t queued;
+        bool finished;
+        std::atomic<bool> stopping;
+
+        std::mutex replyLock;
+        std::vector<Reply> replies;
+
+        Histogram waits, totals;
+        std::atomic<uint64_t> served, evalProbes, evalHits;
+
+        /**
+         * A method to watch a descriptor.
+         *
+         * @param fd the descriptor
+         * @param id the identifier of its events
+         * @param events the events to watch for
+         * @param op EPOLL_CTL_ADD or EPOLL_CTL_MOD
+         */
+        void watch(const int fd, const uint64_t id, const uint32_t events,
+                   const int op = EPOLL_CTL_ADD) const {
+            epoll_event e {};
+            e.events = events;
+            e.data.u64 = id;
+            epoll_ctl(epoll, op, fd, &e);
+        }
+
+        /**
+         * A method to take the next batch of requests, a fair
+         * share of those queued.
+         *
+         * @param batch the batch to fill
+         * @return whether or not there was one, false once the
+         * server is shutting down
+         */
+        bool take(std::vector<Request>& batch) {
+            batch.clear();
+            std::unique_lock<std::mutex> g(requestLock);
+            requestReady.wait(g, [this]
+            { return finished || !requests.empty(); });
+            if(finished) return false;
+            const size_t share = std::min(BatchSize,
+                    (requests.size() + pool.size() - 1) / pool.size());
+            for(size_t i = 0; i < share; ++i) {
+                batch.push_back(std::move(requests.front()));
+                requests.pop_front();
+            }
+            return true;
+        }
+
+        /**
+         * A method to carry out one search.
+         *
+         * @param search the search to use
+         * @param r the request
+         * @return the reply
+         */
+        std::string serve(Search& search, const Request& r) {
+            const Clock::time_point start = Clock::now();
+            State s;
+            Board::Builder builder(s);
+            if(!parseFen(r.fen, builder))
+                return "{\"tag\":" + quote(r.tag) +
+                       ",\"error\":\"unreadable position\"}";
+            const Board b = builder.build();
+            search.setBoard(b);
+            search.clearSignals();
+            // A stop requested just before the signals were
+            // cleared must not be lost.
+            if(stopping.load()) search.requestStop();
+            const Move best = search.think(r.limits);
+            const PvLine line = search.line(0);
+            const uint64_t nodes = search.nodeCount();
+            std::string move = "null";
+            if(best != NullMove) {
+                Move steps[MaxMoveSteps];
+                const int n = completeMove(search, b, best, line, steps);
+                move = '"' + toMoveText(steps, n) + '"';
+            }
+            const Clock::time_point end = Clock::now();
+            const uint64_t wait = micros(r.arrival, start);
+            const uint64_t total = micros(r.arrival, end);
+            waits.add(wait);
+            totals.add(total);
+            served.fetch_add(1, std::memory_order_relaxed);
+            const SearchStats& stats = search.statistics();
+            evalProbes.fetch_add(stats.evalProbes, std::memory_order_relaxed);
+            evalHits.fetch_add(stats.evalHits, std::memory_order_relaxed);
+            return "{\"tag\":" + quote(r.tag) + ",\"move\":" + move +
+                   ",\"score\":" + std::to_string(line.score) +
+                   ",\"depth\":" + std::to_string(line.depth) +
+                   ",\"nodes\":" + std::to_string(nodes) +
+                   ",\"wait\":" + std::to_string(wait) +
+                   ",\"time\":" + std::to_string(total) + '}';
+        }
+
+        /**
+         * A method to run a search thread.
+         *
+         * @param t the index of the thread
+         */
+        void work(const size_t t) {
+            std::vector<Request> batch;
+            while(take(batch))
+                for(const Request& r: batch) {
+                    if(stopping.load()) return;
+                    // Each reply goes out as its search ends, not
+                    // with the rest of the batch, so that the time
+                    // it reports is the time its client waits.
+                    Reply done { r.client, serve(*searches[t], r) };
+                    {
+                        std::lock_guard<std::mutex> g(replyLock);
+                        replies.push_back(std::move(done));
+                    }
+                    const uint64_t one = 1;
+                    (void) !write(wake, &one, sizeof(one));
+                }
+        }
+
+        /**
+         * A method to send what a client is owed, as much as
+         * its socket takes, watching for room for the rest.
+         *
+         * @param id the identifier of the client
+         * @param c the client
+         * @return whether or not to keep the client, false if
+         * its connection has failed or it is owed nothing more
+         */
+        bool flush(const uint64_t id, Client& c) {
+            while(!c.out.empty()) {
+                const ssize_t n = send(c.fd, c.out.data(), c.out.size(),
+                                       MSG_NOSIGNAL);
+                if(n > 0) c.out.erase(0, (size_t) n);
+                else if(n < 0 && errno == EINTR) continue;
+                else if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    break;
+                else return false;
+            }
+            const uint32_t events = (c.ended? 0U: (uint32_t) EPOLLIN) |
+                                    (c.out.empty()? 0U: (uint32_t) EPOLLOUT);
+            if(events != c.events) {
+                c.events = events;
+                watch(c.fd, id, events, EPOLL_CTL_MOD);
+            }
+            return !c.ended || c.pending || !c.out.empty();
+        }
+
+        /**
+         * A method to disconnect a client. Any of its requests
+         * still queued are searched, and their replies dropped.
+         *
+         * @param id the identifier of the client
+         */
+        void disconnect(const uint64_t id) {
+            const auto it = clients.find(id);
+            if(it == clients.end()) return;
+            epoll_ctl(epoll, EPOLL_CTL_DEL, it->second.fd, nullptr);
+            ::close(it->second.fd);
+            clients.erase(it);
+        }
+
+        /**
+         * A method to read one request line.
+         *
+         * @param id the identifier of the client
+         * @param c the client
+         * @param line the line
+         * @param batch the requests to add a search to
+         */
+        void parse(const uint64_t id, Client& c, const std::string& line,
+                   std::vector<Request>& batch) {
+            std::istringstream args(line);
+            Request r { id, {}, {}, {}, Clock::now() };
+            if(!(args >> r.tag)) return;
+            if(!(args >> r.fen)) {
+                c.out += "{\"tag\":" + quote(r.tag) +
+                         ",\"error\":\"no position\"}\n";
+                return;
+            }
+            if(r.fen == "stats") {
+                c.out += "{\"tag\":" + quote(r.tag) + ",\"served\":" +
+                         std::to_string(served.load()) +
+                         ",\"wait\":" + waits.toJson() +
+                         ",\"time\":" + totals.toJson() +
+                         ",\"eval-probes\":" +
+                         std::to_string(evalProbes.load()) +
+                         ",\"eval-hits\":" +
+                         std::to_string(evalHits.load()) + "}\n";
+                return;
+            }
+            r.limits.depth = defaultDepth;
+            bool readable = true, deep = false;
+            for(std::string token; readable && args >> token;) {
+                int64_t v = 0;
+                readable = args >> v && v > 0;
+                if(!readable) break;
+                if(token == "depth") {
+                    r.limits.depth = (int) std::min<int64_t>(v, MaxDepth);
+                    deep = true;
+                } else if(token == "nodes") r.limits.nodes = (uint64_t) v;
+                else if(token == "movetime") r.limits.moveTime = v;
+                else readable = false;
+            }
+            if(!readable) {
+                c.out += "{\"tag\":" + quote(r.tag) +
+                         ",\"error\":\"unreadable limits\"}\n";
+                return;
+            }
+            // A node or time limit alone searches as deep as it
+            // allows.
+            if(!deep && (r.limits.nodes || r.limits.moveTime))
+                r.limits.depth = MaxDepth;
+            ++c.pending;
+            batch.push_back(std::move(r));
+        }
+
+        /**
+         * A method to read what a client has sent.
+         *
+         * @param id the identifier of the client
+         * @param c the client
+         * @param batch the requests to add the searches to
+         * @return whether or not the client is still connected
+         */
+        bool receive(const uint64_t id, Client& c,
+                     std::vector<Request>& batch) {
+            char buffer[1 << 16];
+            for(;;) {
+                const ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+                if(n > 0) c.in.append(buffer, (size_t) n);
+                else if(n == 0) {
+                    c.ended = true;
+                    break;
+                } else if(errno == EINTR) continue;
+                else if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+                else return false;
+            }
+            size_t begin = 0;
+            for(size_t end; (end = c.in.find('\n', begin)) !=
+                            std::string::npos; begin = end + 1)
+                parse(id, c, c.in.substr(begin, end - begin), batch);
+            c.in.erase(0, begin);
+            return c.in.size() <= MaxLineLength && flush(id, c);
+        }
+
+        /** A method to accept every client waiting. */
+        void accept() {
+            for(int fd; (fd = accept4(listener, nullptr, nullptr,
+                                      SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0;) {
+                const uint64_t id = nextClientId++;
+                clients[id] = { fd, {}, {}, 0, EPOLLIN, false };
+                watch(fd, id, EPOLLIN);
+            }
+        }
+
+        /** A method to hand the replies to their clients. */
+        void deliver() {
+            uint64_t count;
+            (void) !read(wake, &count, sizeof(count));
+            std::vector<Reply> ready;
+            {
+                std::lock_guard<std::mutex> g(replyLock);
+                ready.swap(replies);
+            }
+            std::vector<uint64_t> touched;
+            for(Reply& r: ready) {
+                const auto it = clients.find(r.client);
+                if(it == clients.end()) continue;
+                if(it->second.out.empty()) touched.push_back(r.client);
+                it->second.out += r.line;
+                it->second.out.push_back('\n');
+                --it->second.pending;
+            }
+            for(const uint64_t id: touched) {
+                const auto it = clients.find(id);
+                if(it != clients.end() && !flush(id, it->second))
+                    disconnect(id);
+            }
+        }
+
+    public:
+        Server(const size_t tableMegabytes, const int threads,
+               const int defaultDepth) :
+                listener(-1),
+                wake(-1),
+                signals(-1),
+                epoll(-1),
+                nextClientId(FirstClientId),
+                tt(tableMegabytes),
+                evalCache(EvalCacheMegabytes),
+                defaultDepth(defaultDepth),
+                queued(0),
+                finished(false),
+                stopping(false),
+                served(0),
+                evalProbes(0),
+                evalHits(0) {
+            State s;
+            const Board root = Board::Builder(s).build();
+            for(int t = 0; t < threads; ++t) {
+                searches.push_back(std::make_unique<Search>(root, tt));
+                searches[t]->setEvalCache(&evalCache);
+            }
+        }
+
+        ~Server() {
+            for(auto& [id, c]: clients) ::close(c.fd);
+            for(const int fd: { listener, wake, signals, epoll })
+                if(fd >= 0) ::close(fd);
+        }
+
+        Server(const Server&) = delete;
+
+        /**
+         * A method to pass the evaluation and endgame database
+         * to every search.
+         */
+        void configure(const Network* const n, const Patterns* const p,
+                       const egdb::Database* const d) {
+            for(std::unique_ptr<Search>& s: searches) {
+                s->setNetwork(n);
+                s->setPatterns(p);
+                s->setEndgameDatabase(d);
+            }
+        }
+
+        /**
+         * A method to listen on a socket, replacing any file
+         * left at its path.
+         *
+         * @param path the path of the socket
+         * @return whether or not the server is listening
+         */
+        bool listen(const std::string& path) {
+            sockaddr_un address {};
+            if(path.size() >= sizeof(address.sun_path)) return false;
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+            ::unlink(path.c_str());
+            listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK |
+                                       SOCK_CLOEXEC, 0);
+            if(listener < 0 ||
+               bind(listener, (const sockaddr*) &address,
+                    sizeof(address)) ||
+               ::listen(listener, SOMAXCONN))
+                return false;
+
+            // The signals are taken by the event loop, so every
+            // thread must block them.
+            sigset_t mask;
+            sigemptyset(&mask);
+            sigaddset(&mask, SIGINT);
+            sigaddset(&mask, SIGTERM);
+            pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+            signals = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+            wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            epoll = epoll_create1(EPOLL_CLOEXEC);
+            if(signals < 0 || wake < 0 || epoll < 0) return false;
+            watch(listener, ListenerId, EPOLLIN);
+            watch(wake, WakeId, EPOLLIN);
+            watch(signals, SignalId, EPOLLIN);
+            return true;
+        }
+
+        /**
+         * A method to start the search threads, pinning each
+         * to a core in turn, and to run the event loop until a
+         * signal to stop.
+         */
+        void run() {
+            const unsigned cores = std::max(1U,
+                    std::thread::hardware_concurrency());
+            for(size_t t = 0; t < searches.size(); ++t) {
+                pool.emplace_back(&Server::work, this, t);
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(t % cores, &set);
+                pthread_setaffinity_np(pool.back().native_handle(),
+                                       sizeof(set), &set);
+            }
+
+            epoll_event events[MaxEvents];
+            std::vector<Request> batch;
+            for(bool running = true; running;) {
+                const int n = epoll_wait(epoll, events, MaxEvents, -1);
+                if(n < 0 && errno != EINTR) break;
+                batch.clear();
+                for(int i = 0; i < n; ++i) {
+                    const uint64_t id = events[i].data.u64;
+                    if(id == ListenerId) accept();
+                    else if(id == WakeId) deliver();
+                    else if(id == SignalId) running = false;
+                    else {
+                        const auto it = clients.find(id);
+                        if(it == clients.end()) continue;
+                        Client& c = it->second;
+                        const bool open =
+                                !(events[i].events & (EPOLLERR | EPOLLHUP))
+                                || (events[i].events & EPOLLIN);
+                        if(!open ||
+                           ((events[i].events & EPOLLIN) &&
+                            !receive(id, c, batch)) ||
+                           ((events[i].events & EPOLLOUT) && !flush(id, c)))
+                            disconnect(id);
+                    }
+                }
+                if(batch.empty()) continue;
+                {
+                    std::lock_guard<std::mutex> g(requestLock);
+                    for(Request& r: batch) {
+                        if(queued++ % pool.size() == 0) tt.newSearch();
+                        requests.push_back(std::move(r));
+                    }
+                }
+                requestReady.notify_all();
+            }
+
+            {
+                std::lock_guard<std::mutex> g(requestLock);
+                finished = true;
+            }
+            requestReady.notify_all();
+            stopping.store(true);
+            for(std::unique_ptr<Search>& s: searches) s->requestStop();
+            for(std::thread& th: pool) th.join();
+        }
+    };
+}
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <socket> [threads]"
+                     " [--depth n] [--hash mb] [--weights file]"
+                     " [--egdb dir]\n";
+        return 1;
+    }
+    int threads = (int) std::max(1U, std::thread::hardware_concurrency());
+    int depth = DefaultDepth;
+    size_t tableMegabytes = DefaultTableMegabytes;
+    const char* weights = nullptr;
+    const char* egdbDir = nullptr;
+    for(int i = 2; i < argc; ++i) {
+        const bool valued = i + 1 < argc;
+        if(!std::strcmp(argv[i], "--depth") && valued)
+            depth = std::max(1, std::atoi(argv[++i]));
+        else if(!std::strcmp(argv[i], "--hash") && valued)
+            tableMegabytes = std::max(1L, std::atol(argv[++i]));
+        else if(!std::strcmp(argv[i], "--weights") && valued)
+            weights = argv[++i];
+        else if(!std::strcmp(argv[i], "--egdb") && valued)
+            egdbDir = argv[++i];
+        else if(i == 2 && std::atoi(argv[i]) > 0)
+            threads = std::atoi(argv[i]);
+        else {
+            std::cerr << "Unknown argument " << argv[i] << '\n';
+            return 1;
+        }
+    }
+
+    Network network;
+    Patterns patterns;
+    if(weights && !network.load(weights) && !patterns.load(weights)) {
+        std::cerr << "Cannot load weights " << weights << '\n';
+        return 1;
+    }
+    egdb::Database database;
+    egdb::BlockCache blockCache(16);
+    if(egdbDir) {
+        if(!database.open(egdbDir, 8)) {
+            std::cerr << "Cannot open endgame database " << egdbDir << '\n';
+            return 1;
+        }
+        database.setCache(&blockCache);
+    }
+
+    Server server(tableMegabytes, threads, depth);
+    server.configure(network.loaded()? &network: nullptr,
+                     patterns.loaded()? &patterns: nullptr,
+                     egdbDir? &database: nullptr);
+    if(!server.listen(argv[1])) {
+        std::cerr << "Cannot listen on " << argv[1] << '\n';
+        return 1;
+    }
+    std::cout << "listening on " << argv[1] << " with " << threads
+              << " threads" << std::endl;
+    server.run();
+    ::unlink(argv[1]);
+    return 0;
+}
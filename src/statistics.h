@@ -0,0 +1,373 @@
+#ifndef BITCHECKERS_STATISTICS_H
+#define BITCHECKERS_STATISTICS_H
+
+#include <cstdint>
+#include <ostream>
+#include "history.h"
+
+/**
+ * A macro to evaluate a statistics update, unless the build
+ * defines NSTATS, in which case the update is compiled out
+ * and the search pays nothing for it.
+ */
+#ifdef NSTATS
+#define SEARCH_STAT(x) ((void) 0)
+#else
+#define SEARCH_STAT(x) ((void) (x))
+#endif
+
+namespace checkers::opponent {
+
+    /**
+     * <summary>
+     * A block of search statistics. Each search thread owns
+     * its own block, so no counter is ever shared; blocks may
+     * be summed to aggregate across threads. The block is
+     * only updated through SEARCH_STAT, so it stays at zero
+     * in a build with NSTATS.
+     * </summary>
+     *
+     * @struct SearchStats
+     */
+    struct SearchStats final {
+
+        /** The number of nodes visited, quiescence included. */
+        uint64_t nodes;
+
+        /** The number of quiescence nodes visited. */
+        uint64_t qnodes;
+
+        /** The number of main search nodes visited at each ply. */
+        uint64_t plyNodes[MaxPly];
+
+        /** The number of quiescence nodes visited at each ply. */
+        uint64_t plyQNodes[MaxPly];
+
+        /** The number of transposition table probes. */
+        uint64_t ttProbes;
+
+        /** The number of transposition table probes that hit. */
+        uint64_t ttHits;
+
+        /**
+         * The number of transposition table hits whose bound
+         * ended the search of the node.
+         */
+        uint64_t ttCutoffs;
+
+        /** The number of evaluation cache probes. */
+        uint64_t evalProbes;
+
+        /** The number of evaluation cache probes that hit. */
+        uint64_t evalHits;
+
+        /** The number of endgame database probes. */
+        uint64_t egdbProbes;
+
+        /** The number of endgame database probes that hit. */
+        uint64_t egdbHits;
+
+        /** The number of positions found in the bitbase. */
+        uint64_t bitbaseHits;
+
+        /** The number of beta cutoffs. */
+        uint64_t betaCutoffs;
+
+        /** The number of beta cutoffs caused by the first move. */
+        uint64_t firstMoveCutoffs;
+
+        /** The number of beta cutoffs caused by a killer move. */
+        uint64_t killerCutoffs;
+
+        /** The number of beta cutoffs caused by a counter move. */
+        uint64_t counterCutoffs;
+
+        /**
+         * The number of beta cutoffs caused by a quiet move
+         * ordered by butterfly history alone.
+         */
+        uint64_t historyCutoffs;
+
+        /**
+         * The number of null window searches that failed high
+         * and were searched again with the full window.
+         */
+        uint64_t researches;
+
+        /**
+         * The number of root searches that fell outside their
+         * aspiration window and were searched again.
+         */
+        uint64_t aspirationFails;
+
+        /** The number of late moves searched at reduced depth. */
+        uint64_t reductions;
+
+        /**
+         * The number of reduced searches that failed high and
+         * were searched again at full depth.
+         */
+        uint64_t reductionResearches;
+
+        /** The number of moves pruned by futility pruning. */
+        uint64_t futilityPrunes;
+
+        /** The number of ProbCut verification searches. */
+        uint64_t probCutTries;
+
+        /** The number of nodes cut by ProbCut. */
+        uint64_t probCutCutoffs;
+
+        /**
+         * The number of nodes visited when the current
+         * iteration started.
+         */
+        uint64_t iterationStart;
+
+        /**
+         * The number of nodes spent on the last two completed
+         * iterations.
+         */
+        uint64_t lastIteration, previousIteration;
+
+        /**
+         * A default constructor for SearchStats, which starts
+         * with every counter at zero.
+         */
+        constexpr SearchStats() :
+                nodes(0),
+                qnodes(0),
+                plyNodes(),
+                plyQNodes(),
+                ttProbes(0),
+                ttHits(0),
+                ttCutoffs(0),
+                evalProbes(0),
+                evalHits(0),
+                egdbProbes(0),
+                egdbHits(0),
+                bitbaseHits(0),
+                betaCutoffs(0),
+                firstMoveCutoffs(0),
+                killerCutoffs(0),
+                counterCutoffs(0),
+                historyCutoffs(0),
+                researches(0),
+                aspirationFails(0),
+                reductions(0),
+                reductionResearches(0),
+                futilityPrunes(0),
+                probCutTries(0),
+                probCutCutoffs(0),
+                iterationStart(0),
+                lastIteration(0),
+                previousIteration(0)
+        {  }
+
+        /**
+         * A method to reset every counter to zero.
+         */
+        constexpr void clear() { *this = SearchStats(); }
+
+        /**
+         * A method to count a main search node.
+         *
+         * @param ply the distance of the node from the root
+         */
+        constexpr void visit(const int ply) {
+            ++nodes;
+            ++plyNodes[ply];
+        }
+
+        /**
+         * A method to count a quiescence node.
+         *
+         * @param ply the distance of the node from the root
+         */
+        constexpr void qvisit(const int ply) {
+            ++nodes;
+            ++qnodes;
+            ++plyQNodes[ply];
+        }
+
+        /**
+         * A method to count a transposition table probe.
+         *
+         * @param hit whether or not the probe hit
+         */
+        constexpr void probe(const bool hit) {
+            ++ttProbes;
+            ttHits += hit;
+        }
+
+        /**
+         * A method to count an evaluation cache probe.
+         *
+         * @param hit whether or not the probe hit
+         */
+        constexpr void evalProbe(const bool hit) {
+            ++evalProbes;
+            evalHits += hit;
+        }
+
+        /**
+         * A method to record the completion of an iteration
+         * of iterative deepening.
+         */
+        constexpr void iterationDone() {
+            previousIteration = lastIteration;
+            lastIteration = nodes - iterationStart;
+            iterationStart = nodes;
+        }
+
+        /**
+         * A method to compute the effective branching factor,
+         * the growth in nodes from one iteration to the next.
+         *
+         * @return the effective branching factor, or zero
+         * before two iterations have completed
+         */
+        [[nodiscard]]
+        constexpr double branchingFactor() const {
+            return previousIteration?
+                (double) lastIteration / (double) previousIteration: 0;
+        }
+
+        /**
+         * A method to compute the fraction of transposition
+         * table probes that hit.
+         *
+         * @return the hit rate, in [0, 1]
+         */
+        [[nodiscard]]
+        constexpr double ttHitRate() const
+        { return ttProbes? (double) ttHits / (double) ttProbes: 0; }
+
+        /**
+         * A method to compute the fraction of evaluation cache
+         * probes that hit.
+         *
+         * @return the hit rate, in [0, 1]
+         */
+        [[nodiscard]]
+        constexpr double evalHitRate() const {
+            return evalProbes?
+                (double) evalHits / (double) evalProbes: 0;
+        }
+
+        /**
+         * A method to compute the fraction of transposition
+         * table probes that ended the search of the node.
+         *
+         * @return the cutoff rate, in [0, 1]
+         */
+        [[nodiscard]]
+        constexpr double ttCutoffRate() const
+        { return ttProbes? (double) ttCutoffs / (double) ttProbes: 0; }
+
+        /**
+         * A method to compute the fraction of beta cutoffs
+         * caused by the first move searched.
+         *
+         * @return the first-move cutoff rate, in [0, 1]
+         */
+        [[nodiscard]]
+        constexpr double firstMoveCutoffRate() const {
+            return betaCutoffs?
+                (double) firstMoveCutoffs / (double) betaCutoffs: 0;
+        }
+
+        /**
+         * An operator overload to accumulate the counters of
+         * another block into this one.
+         *
+         * @param other the block to add
+         * @return a reference to this block
+         */
+        constexpr SearchStats& operator+=(const SearchStats& other) {
+            nodes            += other.nodes;
+            qnodes           += other.qnodes;
+            for(int i = 0; i < MaxPly; ++i) {
+                plyNodes[i]  += other.plyNodes[i];
+                plyQNodes[i] += other.plyQNodes[i];
+            }
+            ttProbes         += other.ttProbes;
+            ttHits           += other.ttHits;
+            ttCutoffs        += other.ttCutoffs;
+            evalProbes       += other.evalProbes;
+            evalHits         += other.evalHits;
+            egdbProbes       += other.egdbProbes;
+            egdbHits         += other.egdbHits;
+            bitbaseHits      += other.bitbaseHits;
+            betaCutoffs      += other.betaCutoffs;
+            firstMoveCutoffs += other.firstMoveCutoffs;
+            killerCutoffs    += other.killerCutoffs;
+            counterCutoffs   += other.counterCutoffs;
+            historyCutoffs   += other.historyCutoffs;
+            researches       += other.researches;
+            aspirationFails  += other.aspirationFails;
+            reductions       += other.reductions;
+            reductionResearches += other.reductionResearches;
+            futilityPrunes   += other.futilityPrunes;
+            probCutTries     += other.probCutTries;
+            probCutCutoffs   += other.probCutCutoffs;
+            iterationStart   += other.iterationStart;
+            lastIteration    += other.lastIteration;
+            previousIteration += other.previousIteration;
+            return *this;
+        }
+
+        /**
+         * An overloaded insertion operator to print these
+         * statistics as a single line of key/value pairs. The
+         * per-ply counts are printed as comma-separated lists,
+         * up to the deepest ply reached.
+         *
+         * @param out the output stream to use
+         * @param s the statistics to print
+         * @return a reference to the output stream, for
+         * chaining purposes
+         */
+        friend std::ostream&
+        operator<<(std::ostream& out, const SearchStats& s) {
+            int plies = MaxPly;
+            while(plies > 1 && !s.plyNodes[plies - 1] &&
+                  !s.plyQNodes[plies - 1]) --plies;
+            out << "nodes "   << s.nodes
+                << " qnodes " << s.qnodes
+                << " ebf "    << s.branchingFactor()
+                << " tt-probes " << s.ttProbes
+                << " tt-hits " << s.ttHits
+                << " tt-cutoffs " << s.ttCutoffs
+                << " tt-hit-rate " << s.ttHitRate()
+                << " tt-cutoff-rate " << s.ttCutoffRate()
+                << " eval-probes " << s.evalProbes
+                << " eval-hits " << s.evalHits
+                << " eval-hit-rate " << s.evalHitRate()
+                << " egdb-probes " << s.egdbProbes
+                << " egdb-hits " << s.egdbHits
+                << " bitbase-hits " << s.bitbaseHits
+                << " ply-nodes ";
+            for(int i = 0; i < plies; ++i)
+                out << (i? ",": "") << s.plyNodes[i];
+            out << " ply-qnodes ";
+            for(int i = 0; i < plies; ++i)
+                out << (i? ",": "") << s.plyQNodes[i];
+            return out << " cutoffs " << s.betaCutoffs
+                       << " first "   << s.firstMoveCutoffs
+                       << " killer "  << s.killerCutoffs
+                       << " counter " << s.counterCutoffs
+                       << " history " << s.historyCutoffs
+                       << " researches " << s.researches
+                       << " aspiration " << s.aspirationFails
+                       << " lmr " << s.reductions
+                       << " lmr-researches " << s.reductionResearches
+                       << " futility " << s.futilityPrunes
+                       << " probcut-tries " << s.probCutTries
+                       << " probcut " << s.probCutCutoffs
+                       << " fmc "     << s.firstMoveCutoffRate();
+        }
+    };
+}
+
+#endif //BITCHECKERS_STATISTICS_H
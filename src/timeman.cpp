@@ -0,0 +1,72 @@
+#include <algorithm>
+#include "timeman.h"
+
+namespace checkers::opponent {
+    namespace {
+
+        /** The least growth assumed between two iterations. */
+        constexpr double MinGrowth = 1.5;
+
+        /** The most growth assumed between two iterations. */
+        constexpr double MaxGrowth = 6.0;
+
+        /** The growth assumed before two iterations complete. */
+        constexpr double DefaultGrowth = 4.0;
+    }
+
+    TimeManager::TimeManager() :
+            start(Clock::now()),
+            optimumTime(INT64_MAX),
+            maximumTime(INT64_MAX),
+            lastIteration(0),
+            previousIteration(0),
+            timed(false)
+    {  }
+
+    void TimeManager::init(const SearchLimits& limits,
+                           const Alliance us) {
+        start = Clock::now();
+        optimumTime = maximumTime = INT64_MAX;
+        lastIteration = previousIteration = 0;
+        timed = false;
+        if(limits.infinite) return;
+        if(limits.moveTime > 0) {
+            timed = true;
+            optimumTime = maximumTime =
+                    std::max<int64_t>(1, limits.moveTime - MoveOverhead);
+            return;
+        }
+        if(limits.time[us] > 0) {
+            timed = true;
+            const int64_t left =
+                    std::max<int64_t>(1, limits.time[us] - MoveOverhead);
+            const int movesToGo = limits.movesToGo > 0?
+                    std::min(limits.movesToGo, 50): DefaultMovesToGo;
+            optimumTime = left / movesToGo +
+                    limits.increment[us] * 3 / 4;
+            maximumTime = std::min(optimumTime * 5, left * 4 / 5);
+            optimumTime = std::clamp<int64_t>(optimumTime, 1,
+                    std::max<int64_t>(1, maximumTime));
+            maximumTime = std::max(maximumTime, optimumTime);
+        }
+    }
+
+    void TimeManager::iterationDone(const int64_t duration) {
+        previousIteration = lastIteration;
+        lastIteration = duration;
+    }
+
+    bool TimeManager::startNextIteration() const {
+        if(!timed) return true;
+        const int64_t now = elapsed();
+        if(now >= optimumTime) return false;
+        const double growth = previousIteration > 0?
+                std::clamp((double) lastIteration /
+                           (double) previousIteration,
+                           MinGrowth, MaxGrowth): DefaultGrowth;
+        // An iteration that cannot finish before the maximum
+        // time would only be thrown away.
+        return (double) now + (double) lastIteration * growth
+               <= (double) maximumTime;
+    }
+}
@@ -0,0 +1,199 @@
+#ifndef BITCHECKERS_TIMEMAN_H
+#define BITCHECKERS_TIMEMAN_H
+
+#include <chrono>
+#include <cstdint>
+#include "utility.h"
+
+namespace checkers::opponent {
+    using namespace utility;
+
+    /** The maximum depth of an iterative deepening search. */
+    constexpr int MaxDepth = 64;
+
+    /**
+     * <summary>
+     * The limits of a single search. Every limit left at zero
+     * is ignored; a search with no limit at all runs to
+     * MaxDepth or until stopped. Times are in milliseconds.
+     * </summary>
+     *
+     * @struct SearchLimits
+     */
+    struct SearchLimits final {
+
+        /** The maximum depth to search. */
+        int depth = MaxDepth;
+
+        /** The maximum number of nodes to search. */
+        uint64_t nodes = 0;
+
+        /** The exact time to spend on this move. */
+        int64_t moveTime = 0;
+
+        /** The time left on each player's clock. */
+        int64_t time[2] = { 0, 0 };
+
+        /** The increment of each player's clock. */
+        int64_t increment[2] = { 0, 0 };
+
+        /** The number of moves until the next time control. */
+        int movesToGo = 0;
+
+        /** Whether or not to search until stopped. */
+        bool infinite = false;
+
+        /**
+         * Whether or not to search on the opponent's time. The
+         * other limits take effect only after a ponder hit.
+         */
+        bool ponder = false;
+    };
+
+    /**
+     * <summary>
+     *  <p>
+     * A controller for the time spent on a single search. It
+     * computes an optimum time, which the search should not
+     * start a new iteration beyond, and a maximum time, at
+     * which the search must stop mid-iteration.
+     *  </p>
+     *  <p>
+     * The search polls the controller only every few
+     * thousand nodes, so the clock is never read per node.
+     *  </p>
+     * </summary>
+     *
+     * @class TimeManager
+     */
+    class TimeManager final {
+    public:
+
+        /** The clock used for all timing. */
+        using Clock = std::chrono::steady_clock;
+
+    private:
+
+        /**
+         * @private
+         * The time at which the search started.
+         */
+        Clock::time_point start;
+
+        /**
+         * @private
+         * The time after which no new iteration should start.
+         */
+        int64_t optimumTime;
+
+        /**
+         * @private
+         * The time at which the search must stop.
+         */
+        int64_t maximumTime;
+
+        /**
+         * @private
+         * The time spent on the last two completed iterations.
+         */
+        int64_t lastIteration, previousIteration;
+
+        /**
+         * @private
+         * Whether or not the search is limited by time.
+         */
+        bool timed;
+
+    public:
+
+        /**
+         * The time kept in reserve to cover the latency between
+         * the search stopping and the move reaching the client.
+         */
+        static constexpr int64_t MoveOverhead = 10;
+
+        /**
+         * The number of moves assumed left in the game when
+         * the limits do not say.
+         */
+        static constexpr int DefaultMovesToGo = 30;
+
+        /** A default constructor for an untimed TimeManager. */
+        TimeManager();
+
+        /**
+         * A method to start the clock and allocate time for a
+         * search.
+         *
+         * @param limits the limits of the search
+         * @param us the player to move
+         */
+        void init(const SearchLimits& limits, Alliance us);
+
+        /**
+         * A method to record the completion of an iteration.
+         *
+         * @param duration the time spent on the iteration
+         */
+        void iterationDone(int64_t duration);
+
+        /**
+         * A method to decide whether another iteration is
+         * likely to complete before the optimum time, given
+         * how the last iterations grew.
+         *
+         * @return whether or not to start another iteration
+         */
+        [[nodiscard]]
+        bool startNextIteration() const;
+
+        /**
+         * A method to get the time elapsed since the search
+         * started.
+         *
+         * @return the elapsed time, in milliseconds
+         */
+        [[nodiscard]]
+        int64_t elapsed() const {
+            return std::chrono::duration_cast<
+                    std::chrono::milliseconds>(
+                    Clock::now() - start).count();
+        }
+
+        /**
+         * A method to check whether the search must stop now.
+         *
+         * @return whether or not the maximum time has passed
+         */
+        [[nodiscard]]
+        bool outOfTime() const
+        { return timed && elapsed() >= maximumTime; }
+
+        /**
+         * A method to check whether the search is limited by
+         * time.
+         *
+         * @return whether or not the search is timed
+         */
+        [[nodiscard]]
+        constexpr bool isTimed() const { return timed; }
+
+        /**
+         * A method to expose the optimum time.
+         *
+         * @return the optimum time, in milliseconds
+         */
+        [[nodiscard]]
+        constexpr int64_t optimum() const { return optimumTime; }
+
+        /**
+         * A method to expose the maximum time.
+         *
+         * @return the maximum time, in milliseconds
+         */
+        [[nodiscard]]
+        constexpr int64_t maximum() const { return maximumTime; }
+    };
+}
+
+#endif //BITCHECKERS_TIMEMAN_H
@@ -0,0 +1,132 @@
+#include "ttable.h"
+
+namespace checkers::opponent {
+    namespace {
+
+        /**
+         * A method to pack the data of an entry into a single
+         * 64-bit word.
+         * <ul>
+         *  <li>bits 15-0 : move</li>
+         *  <li>bits 31-16: score (signed)</li>
+         *  <li>bits 39-32: depth</li>
+         *  <li>bits 41-40: bound</li>
+         *  <li>bits 47-42: generation</li>
+         * </ul>
+         */
+        constexpr uint64_t
+        pack(const Move m, const int score, const int depth,
+             const Bound b, const uint8_t generation) {
+            return (uint64_t) (uint16_t) m.getManifest()
+                 | (uint64_t) (uint16_t) (int16_t) score << 16U
+                 | (uint64_t) (uint8_t) depth << 32U
+                 | (uint64_t) b << 40U
+                 | (uint64_t) generation << 42U;
+        }
+
+        constexpr Move moveOf(const uint64_t d)
+        { return Move((unsigned int) (d & 0xFFFFU)); }
+
+        constexpr int scoreOf(const uint64_t d)
+        { return (int16_t) (uint16_t) (d >> 16U); }
+
+        constexpr int depthOf(const uint64_t d)
+        { return (int) ((d >> 32U) & 0xFFU); }
+
+        constexpr Bound boundOf(const uint64_t d)
+        { return Bound((d >> 40U) & 0x3U); }
+
+        constexpr uint8_t generationOf(const uint64_t d)
+        { return (uint8_t) ((d >> 42U) & 0x3FU); }
+    }
+
+    TranspositionTable::TranspositionTable(const size_t megabytes) :
+            buckets(nullptr),
+            mask(0),
+            generation(0)
+    { resize(megabytes); }
+
+    TranspositionTable::~TranspositionTable()
+    { delete[] buckets; }
+
+    void TranspositionTable::resize(const size_t megabytes) {
+        const size_t bytes = (megabytes? megabytes: 1) << 20U;
+        size_t n = 1;
+        while((n << 1U) * sizeof(Bucket) <= bytes) n <<= 1U;
+        delete[] buckets;
+        buckets = new Bucket[n];
+        mask = n - 1;
+        clear();
+    }
+
+    void TranspositionTable::clear() {
+        for(uint64_t i = 0; i <= mask; ++i)
+            for(Slot& s: buckets[i].slots) {
+                s.check.store(0, std::memory_order_relaxed);
+                s.data.store(0, std::memory_order_relaxed);
+            }
+        generation.store(0, std::memory_order_relaxed);
+    }
+
+    bool TranspositionTable::probe(const uint64_t key, TTEntry& e) const {
+        for(const Slot& s: bucketOf(key).slots) {
+            const uint64_t
+                d = s.data.load(std::memory_order_relaxed),
+                c = s.check.load(std::memory_order_relaxed);
+            if((c ^ d) != key || boundOf(d) == NullBound)
+                continue;
+            e.move  = moveOf(d);
+            e.score = scoreOf(d);
+            e.depth = depthOf(d);
+            e.bound = boundOf(d);
+            return true;
+        }
+        return false;
+    }
+
+    void TranspositionTable::store(const uint64_t key, Move m,
+                                   const int score, const int depth,
+                                   const Bound b) {
+        Bucket& bucket = bucketOf(key);
+        const uint8_t now = generation.load(std::memory_order_relaxed);
+        Slot* victim = bucket.slots;
+        int worst = INT32_MAX;
+        for(Slot& s: bucket.slots) {
+            const uint64_t
+                d = s.data.load(std::memory_order_relaxed),
+                c = s.check.load(std::memory_order_relaxed);
+            if((c ^ d) == key) {
+                // Keep a much deeper result for the same key.
+                if(depth + 2 < depthOf(d) && b != Exact) return;
+                // Keep the old move when there is no new one.
+                if(m == NullMove) m = moveOf(d);
+                victim = &s;
+                break;
+            }
+            const int age = (now - generationOf(d)) & 0x3F;
+            const int value = boundOf(d) == NullBound?
+                    INT32_MIN: depthOf(d) - 8 * age;
+            if(value < worst) {
+                worst = value;
+                victim = &s;
+            }
+        }
+        const uint64_t d = pack(m, score,
+                depth < 0? 0: depth > 255? 255: depth, b, now);
+        victim->data.store(d, std::memory_order_relaxed);
+        victim->check.store(key ^ d, std::memory_order_relaxed);
+    }
+
+    int TranspositionTable::hashfull() const {
+        const uint64_t n = mask + 1 < 1000? mask + 1: 1000;
+        const uint8_t now = generation.load(std::memory_order_relaxed);
+        int used = 0;
+        for(uint64_t i = 0; i < n; ++i)
+            for(const Slot& s: buckets[i].slots) {
+                const uint64_t d = s.data.load(std::memory_order_relaxed);
+                used += boundOf(d) != NullBound &&
+                        generationOf(d) == now;
+            }
+        return (int) (used * 1000 / (n * BucketSize));
+    }
+}
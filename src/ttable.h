@@ -0,0 +1,176 @@
+#ifndef BITCHECKERS_TTABLE_H
+#define BITCHECKERS_TTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include "move.h"
+
+namespace checkers::opponent {
+
+    /** The bound types of a stored score, enumerated. */
+    enum Bound : uint8_t { NullBound, Upper, Lower, Exact };
+
+    /**
+     * <summary>
+     * The data of a transposition table entry, unpacked.
+     * </summary>
+     *
+     * @struct TTEntry
+     */
+    struct TTEntry final {
+        Move move;
+        int score;
+        int depth;
+        Bound bound;
+    };
+
+    /**
+     * <summary>
+     *  <p>
+     * A shared transposition table. Entries are grouped into
+     * cache-line sized buckets of four slots each.
+     *  </p>
+     *  <p>
+     * Each slot holds its packed data and its key xor-ed
+     * with that data, so that a slot torn by two concurrent
+     * writers is rejected on probe rather than trusted. No
+     * locks are ever taken.
+     *  </p>
+     * </summary>
+     *
+     * @class TranspositionTable
+     */
+    class TranspositionTable final {
+    private:
+
+        /**
+         * @private
+         * A single slot of the table.
+         */
+        struct Slot final {
+            std::atomic<uint64_t> check;
+            std::atomic<uint64_t> data;
+        };
+
+        /** @private The number of slots in a bucket. */
+        static constexpr int BucketSize = 4;
+
+        /**
+         * @private
+         * A cache-line sized group of slots.
+         */
+        struct alignas(64) Bucket final {
+            Slot slots[BucketSize];
+        };
+
+        /**
+         * @private
+         * The buckets of this table.
+         */
+        Bucket* buckets;
+
+        /**
+         * @private
+         * The number of buckets, minus one (a mask).
+         */
+        uint64_t mask;
+
+        /**
+         * @private
+         * The generation of the current search, which lets
+         * stale entries be replaced first. It is read by every
+         * search using the table, but only advanced by its
+         * owner.
+         */
+        std::atomic<uint8_t> generation;
+
+        /**
+         * @private
+         * A method to find the bucket of the given key.
+         *
+         * @param key the key to look up
+         * @return the bucket of the given key
+         */
+        [[nodiscard]]
+        Bucket& bucketOf(const uint64_t key) const
+        { return buckets[key & mask]; }
+
+    public:
+
+        /**
+         * A public constructor for a TranspositionTable.
+         *
+         * @param megabytes the size of the table, rounded down
+         * to a power of two number of buckets
+         */
+        explicit TranspositionTable(size_t megabytes);
+
+        /** A destructor for a TranspositionTable. */
+        ~TranspositionTable();
+
+        /** @public Deleted copy constructor. */
+        TranspositionTable(const TranspositionTable&) = delete;
+
+        /** @public Deleted copy assignment operator. */
+        TranspositionTable&
+        operator=(const TranspositionTable&) = delete;
+
+        /**
+         * A method to reallocate this table, clearing it.
+         *
+         * @param megabytes the new size of the table
+         */
+        void resize(size_t megabytes);
+
+        /**
+         * A method to empty this table.
+         */
+        void clear();
+
+        /**
+         * A method to start a new search, aging every entry
+         * currently in the table. It is called once by the
+         * owner of the table, not by each search sharing it,
+         * so that entries age once per move however many
+         * threads search.
+         */
+        void newSearch() {
+            generation.store((generation.load(std::memory_order_relaxed)
+                              + 1) & 0x3FU, std::memory_order_relaxed);
+        }
+
+        /**
+         * A method to look up the given key.
+         *
+         * @param key the key to look up
+         * @param e the entry to fill on a hit
+         * @return whether or not the key was found
+         */
+        bool probe(uint64_t key, TTEntry& e) const;
+
+        /**
+         * A method to store a search result.
+         *
+         * @param key the key of the position
+         * @param m the best move, or the null move
+         * @param score the score, adjusted to be ply
+         * independent
+         * @param depth the depth searched
+         * @param b the bound type of the score
+         */
+        void store(uint64_t key, Move m,
+                   int score, int depth, Bound b);
+
+        /**
+         * A method to estimate how full this table is by
+         * sampling its first thousand buckets.
+         *
+         * @return the permill of sampled slots used by the
+         * current search
+         */
+        [[nodiscard]]
+        int hashfull() const;
+    };
+}
+
+#endif //BITCHECKERS_TTABLE_H
@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "movegen.h"
+#include "evaluation.h"
+#include "patterns.h"
+#include "fen.h"
+
+using namespace checkers;
+using namespace checkers::opponent;
+
+/*
+ * An offline tuner for the pattern weights, in the manner of
+ * Texel's tuning method. Each labelled position is first
+ * resolved to the quiet position at the end of its jump
+ * sequence, as the search does at its leaves, and kept only
+ * as the handcrafted score and pattern indexes of that
+ * leaf. The pattern weights are then fitted by gradient
+ * descent so that a sigmoid of the evaluation predicts the
+ * game results.
+ *
+ * usage: tuner <positions> <output> [epochs] [threads] [weights]
+ *
+ * Each line of the positions file holds a FEN and the game
+ * result for White: "1-0", "0-1", "1/2-1/2", or 1, 0.5, 0.
+ */
+namespace {
+
+    /** The number of lines read and resolved at a time. */
+    constexpr size_t BlockLines = 1 << 20;
+
+    /** The deepest jump sequence followed. */
+    constexpr int MaxJumpPly = 64;
+
+    /** The weights are rounded and clamped to this range. */
+    constexpr double MaxWeight = 32000;
+
+    /**
+     * The score of a player with no pieces left, below any
+     * evaluation.
+     */
+    constexpr int Lost = -1000000;
+
+    /**
+     * <summary>
+     * A resolved position, kept compact so that tens of
+     * millions fit in memory.
+     * </summary>
+     *
+     * @struct Sample
+     */
+    struct Sample final {
+
+        /** The configuration of each region of the leaf. */
+        uint16_t index[Patterns::Regions];
+
+        /** The handcrafted score of the leaf, for White. */
+        int16_t base;
+
+        /** The result for White, in half points. */
+        uint8_t result;
+    };
+
+    /**
+     * <summary>
+     * The state of a quiescence resolution, one for each
+     * thread.
+     * </summary>
+     *
+     * @struct Resolver
+     */
+    struct Resolver final {
+        const Patterns& patterns;
+        State states[MaxJumpPly];
+        Sample leaves[MaxJumpPly + 1];
+
+        /**
+         * A method to evaluate the current position from the
+         * perspective of the player to move, as the search
+         * does with these pattern weights.
+         *
+         * @param b the board to evaluate
+         * @return the score of the board
+         */
+        int staticEval(const Board& b) const {
+            const int p = patterns.loaded()? patterns.evaluate(b): 0;
+            return evaluate(b) + (b.currentPlayer() == White? p: -p);
+        }
+
+        /**
+         * A method to search only jumps, remembering the leaf
+         * that the best line ends in.
+         *
+         * @param b the board to search
+         * @param alpha the lower bound
+         * @param beta the upper bound
+         * @param ply the distance from the root
+         * @return the score of the board, or Lost if the
+         * player to move has lost
+         */
+        int resolve(Board& b, int alpha, const int beta,
+                    const int ply) {
+            const Alliance us = b.currentPlayer();
+            if(!b.getPieces(us, NullPT)) return Lost;
+            Move moves[movegen::MaxMoves];
+            const int n = ply < MaxJumpPly? (int)
+                (movegen::generate<Aggressive>(moves, &b) - moves): 0;
+            if(n == 0) {
+                Sample& s = leaves[ply];
+                for(int r = 0; r < Patterns::Regions; ++r)
+                    s.index[r] = (uint16_t) Patterns::index(b, r);
+                const int e = evaluate(b);
+                s.base = (int16_t) std::clamp(
+                        us == White? e: -e, -32000, 32000);
+                return staticEval(b);
+            }
+            int best = INT32_MIN;
+            for(int i = 0; i < n; ++i) {
+                b.applyMove(moves[i], states[ply]);
+                const int score = b.currentPlayer() == us?
+                         resolve(b, alpha, beta, ply + 1):
+                        -resolve(b, -beta, -alpha, ply + 1);
+                b.retractMove(moves[i]);
+                if(score > best) {
+                    best = score;
+                    leaves[ply] = leaves[ply + 1];
+                    if(score > alpha) alpha = score;
+                    if(alpha >= beta) break;
+                }
+            }
+            return best;
+        }
+    };
+
+    /**
+     * A method to read a game result for White, as in PDN or
+     * as a score of 1, 0.5 or 0.
+     *
+     * @param s the result to read
+     * @param half the result, in half points
+     * @return whether or not the result could be read
+     */
+    bool readResult(const std::string& s, uint8_t& half) {
+        int points = parseResult(s);
+        if(s == "1" || s == "1.0") points = 2;
+        else if(s == "0.5") points = 1;
+        else if(s == "0" || s == "0.0") points = 0;
+        if(points < 0) return false;
+        half = (uint8_t) points;
+        return true;
+    }
+
+    /**
+     * A method to resolve a slice of lines into samples.
+     *
+     * @param lines the lines to resolve
+     * @param begin the first line of the slice
+     * @param end one past the last line of the slice
+     * @param patterns the pattern weights to resolve with
+     * @param out the samples to append to
+     */
+    void resolveLines(const std::vector<std::string>& lines,
+                      const size_t begin, const size_t end,
+                      const Patterns& patterns,
+                      std::vector<Sample>& out) {
+        Resolver r{patterns, {}, {}};
+        for(size_t i = begin; i < end; ++i) {
+            const std::string& line = lines[i];
+            const size_t space = line.find_last_of(" \t");
+            uint8_t half;
+            if(space == std::string::npos ||
+               !readResult(line.substr(space + 1), half))
+                continue;
+            State s;
+            Board::Builder builder(s);
+            if(!parseFen(std::string_view(line).substr(0, space),
+                         builder))
+                continue;
+            Board b = builder.build();
+            // Positions decided by the jumps alone teach the
+            // evaluation nothing.
+            if(std::abs(r.resolve(b, Lost, -Lost, 0)) >= -Lost) continue;
+            Sample& leaf = r.leaves[0];
+            leaf.result = half;
+            out.push_back(leaf);
+        }
+    }
+
+    /**
+     * A method to compute the predicted result for White of
+     * an evaluation.
+     *
+     * @param score the evaluation for White
+     * @param k the scaling constant
+     * @return the expected result, in [0, 1]
+     */
+    inline double sigmoid(const double score, const double k)
+    { return 1.0 / (1.0 + std::pow(10.0, -k * score / 400.0)); }
+
+    /**
+     * <summary>
+     * The weights being tuned, as floating point values, with
+     * the moment estimates of the Adam optimizer.
+     * </summary>
+     *
+     * @struct Model
+     */
+    struct Model final {
+        static constexpr int Size =
+                Patterns::Regions * Patterns::Configurations;
+        std::vector<double> weights, m, v;
+        Model() : weights(Size), m(Size), v(Size) {}
+
+        /**
+         * A method to evaluate a sample for White.
+         *
+         * @param s the sample to evaluate
+         * @return the evaluation of the sample
+         */
+        [[nodiscard]]
+        double evaluate(const Sample& s) const {
+            double e = s.base;
+            for(int r = 0; r < Patterns::Regions; ++r)
+                e += weights[r * Patterns::Configurations + s.index[r]];
+            return e;
+        }
+    };
+
+    /**
+     * A method to run a function over the samples on several
+     * threads, each with its own slice.
+     *
+     * @param samples the samples to split
+     * @param threads the number of threads
+     * @param f the function to run, given a slice index and
+     * the bounds of the slice
+     */
+    template<class F>
+    void parallel(const std::vector<Sample>& samples,
+                  const int threads, F f) {
+        std::vector<std::thread> pool;
+        const size_t step = (samples.size() + threads - 1) / threads;
+        for(int t = 0; t < threads; ++t)
+            pool.emplace_back(f, t, std::min(samples.size(), t * step),
+                              std::min(samples.size(), (t + 1) * step));
+        for(std::thread& th: pool) th.join();
+    }
+
+    /**
+     * A method to compute the mean squared error of the model
+     * over every sample.
+     *
+     * @param model the model to measure
+     * @param samples the samples to measure with
+     * @param k the scaling constant
+     * @param threads the number of threads
+     * @return the mean squared error
+     */
+    double meanError(const Model& model,
+                     const std::vector<Sample>& samples,
+                     const double k, const int threads) {
+        std::vector<double> sums(threads);
+        parallel(samples, threads,
+                 [&](const int t, const size_t a, const size_t b) {
+            double sum = 0;
+            for(size_t i = a; i < b; ++i) {
+                const double d = sigmoid(model.evaluate(samples[i]), k)
+                               - samples[i].result / 2.0;
+                sum += d * d;
+            }
+            sums[t] = sum;
+        });
+        double sum = 0;
+        for(const double x: sums) sum += x;
+        return sum / (double) samples.size();
+    }
+
+    /**
+     * A method to find the scaling constant that best fits
+     * the current model, by golden section search.
+     *
+     * @return the scaling constant
+     */
+    double fitScale(const Model& model,
+                    const std::vector<Sample>& samples,
+                    const int threads) {
+        const double phi = (std::sqrt(5.0) - 1) / 2;
+        double a = 0.05, b = 4.0;
+        for(int i = 0; i < 40; ++i) {
+            const double c = b - phi * (b - a), d = a + phi * (b - a);
+            if(meanError(model, samples, c, threads) <
+               meanError(model, samples, d, threads))
+                b = d;
+            else a = c;
+        }
+        return (a + b) / 2;
+    }
+
+    /**
+     * A method to run one epoch of full-batch gradient descent
+     * with the Adam optimizer.
+     *
+     * @param model the model to update
+     * @param samples the samples to fit
+     * @param k the scaling constant
+     * @param threads the number of threads
+     * @param epoch the number of the epoch, from one
+     */
+    void descend(Model& model, const std::vector<Sample>& samples,
+                 const double k, const int threads, const int epoch) {
+        constexpr double Rate = 1.0, Beta1 = 0.9, Beta2 = 0.999,
+                         Epsilon = 1e-8;
+        std::vector<std::vector<double>> grads(
+                threads, std::vector<double>(Model::Size));
+        parallel(samples, threads,
+                 [&](const int t, const size_t a, const size_t b) {
+            std::vector<double>& g = grads[t];
+            for(size_t i = a; i < b; ++i) {
+                const Sample& s = samples[i];
+                const double p = sigmoid(model.evaluate(s), k);
+                const double d = (p - s.result / 2.0) * p * (1 - p);
+                for(int r = 0; r < Patterns::Regions; ++r)
+                    g[r * Patterns::Configurations + s.index[r]] += d;
+            }
+        });
+        const double scale = 2.0 * k * std::log(10.0) / 400.0 /
+                             (double) samples.size();
+        for(int i = 0; i < Model::Size; ++i) {
+            double g = 0;
+            for(int t = 0; t < threads; ++t) g += grads[t][i];
+            if(g == 0) continue;
+            g *= scale;
+            model.m[i] = Beta1 * model.m[i] + (1 - Beta1) * g;
+            model.v[i] = Beta2 * model.v[i] + (1 - Beta2) * g * g;
+            const double mh = model.m[i] / (1 - std::pow(Beta1, epoch));
+            const double vh = model.v[i] / (1 - std::pow(Beta2, epoch));
+            model.weights[i] = std::clamp(
+                    model.weights[i] - Rate * mh / (std::sqrt(vh) + Epsilon),
+                    -MaxWeight, MaxWeight);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        std::cerr << "usage: " << argv[0]
+                  << " <positions> <output> [epochs] [threads] [weights]\n";
+        return 1;
+    }
+    const int epochs = argc > 3? std::atoi(argv[3]): 100;
+    const int threads = argc > 4 && std::atoi(argv[4]) > 0?
+            std::atoi(argv[4]):
+            (int) std::max(1U, std::thread::hardware_concurrency());
+    auto patterns = std::make_unique<Patterns>();
+    if(argc > 5 && !patterns->load(argv[5])) {
+        std::cerr << "Cannot load weights " << argv[5] << '\n';
+        return 1;
+    }
+
+    // Read the positions a block at a time, so that only the
+    // compact samples are ever held in full.
+    std::ifstream in(argv[1]);
+    if(!in) {
+        std::cerr << "Cannot read " << argv[1] << '\n';
+        return 1;
+    }
+    std::vector<Sample> samples;
+    std::vector<std::string> lines;
+    size_t read = 0;
+    for(bool more = true; more;) {
+        lines.clear();
+        std::string line;
+        while(lines.size() < BlockLines &&
+              (more = (bool) std::getline(in, line)))
+            lines.push_back(std::move(line));
+        read += lines.size();
+        std::vector<std::vector<Sample>> parts(threads);
+        std::vector<std::thread> pool;
+        const size_t step = (lines.size() + threads - 1) / threads;
+        for(int t = 0; t < threads; ++t)
+            pool.emplace_back(resolveLines, std::cref(lines),
+                              std::min(lines.size(), t * step),
+                              std::min(lines.size(), (t + 1) * step),
+                              std::cref(*patterns), std::ref(parts[t]));
+        for(std::thread& th: pool) th.join();
+        for(const std::vector<Sample>& p: parts)
+            samples.insert(samples.end(), p.begin(), p.end());
+    }
+    std::cout << "lines " << read << " samples " << samples.size()
+              << " bytes " << samples.size() * sizeof(Sample) << '\n';
+    if(samples.empty()) return 1;
+
+    Model model;
+    if(patterns->loaded())
+        for(int r = 0; r < Patterns::Regions; ++r)
+            for(int i = 0; i < Patterns::Configurations; ++i)
+                model.weights[r * Patterns::Configurations + i] =
+                        patterns->weight(r, i);
+    const double k = fitScale(model, samples, threads);
+    std::cout << "k " << k << " error "
+              << meanError(model, samples, k, threads) << '\n';
+    for(int e = 1; e <= epochs; ++e) {
+        descend(model, samples, k, threads, e);
+        if(e % 10 == 0 || e == epochs)
+            std::cout << "epoch " << e << " error "
+                      << meanError(model, samples, k, threads) << '\n';
+    }
+
+    for(int r = 0; r < Patterns::Regions; ++r)
+        for(int i = 0; i < Patterns::Configurations; ++i)
+            patterns->setWeight(r, i, (int16_t) std::lround(
+                    model.weights[r * Patterns::Configurations + i]));
+    if(!patterns->save(argv[2])) {
+        std::cerr << "Cannot write " << argv[2] << '\n';
+        return 1;
+    }
+    return 0;
+}
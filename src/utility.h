@@ -24,7 +24,7 @@ namespace checkers::utility {
 
     /** A table to convert a move type to a string. */
     constexpr const char* MoveTypeToString[] =
-    { "Passive", "Aggressive" };
+    { "Passive", "Aggressive", "Promotion" };
 
     /** A table to convert a piece type to a string. */
     constexpr const char* PieceTypeToString[] =
@@ -246,6 +246,29 @@ namespace checkers::utility {
         return D > 0 ? b << D : b >> -D;
     }
 
+    /**
+     * A method to compute the landing squares of every jump
+     * in the given direction, for the given jumping pieces.
+     * A jump passes over an enemy on the adjacent square and
+     * lands on the empty square behind it.
+     *
+     * @tparam D the direction of the jumps
+     * @param b the jumping pieces
+     * @param enemies the enemy pieces
+     * @param empty the empty squares
+     * @return a bitboard of landing squares
+     */
+    template<Direction D>
+    constexpr uint64_t
+    jumpTargets(const uint64_t b,
+                const uint64_t enemies,
+                const uint64_t empty) {
+        constexpr uint64_t f =
+                D == NorthEast || D == SouthEast?
+                NotEastFile: NotWestFile;
+        return shift<D>(shift<D>(b & f) & enemies & f) & empty;
+    }
+
     /**
      * A method to getPieces the file of the current square
      * (square mod 8).
@@ -266,6 +289,31 @@ namespace checkers::utility {
     constexpr int rankOf(unsigned int square)
     { return (int)(square >> 3U); }
 
+    /**
+     * A method to convert a square into its number in
+     * standard checkers notation (1-32). Only the dark
+     * squares, those whose rank and file differ in parity,
+     * are numbered.
+     *
+     * @param square the square to convert
+     * @return the number of the given square
+     */
+    constexpr int squareToNumber(const unsigned int square)
+    { return (int)(square >> 1U) + 1; }
+
+    /**
+     * A method to convert a number in standard checkers
+     * notation (1-32) into a square.
+     *
+     * @param number the number to convert
+     * @return the square with the given number
+     */
+    constexpr int numberToSquare(const unsigned int number) {
+        const unsigned int r = (number - 1) >> 2U;
+        return (int)((r << 3U) + (((number - 1) & 3U) << 1U) +
+                     ((r & 1U) ^ 1U));
+    }
+
     /**
      * A method to check if a king move in the given
      * direction is within the boundaries of the board.
@@ -321,6 +369,156 @@ namespace checkers::utility {
         return (short)(x >> 56U);
     }
 
+    /**
+     * <summary>
+     * Zobrist keys for hashing a board: one for each
+     * alliance, piece type and square, one for the side to
+     * move, and one for each square from which a multi-jump
+     * must continue.
+     * </summary>
+     *
+     * @struct ZobristKeys
+     */
+    struct ZobristKeys final {
+        uint64_t pieces[2][2][BoardLength];
+        uint64_t side;
+        uint64_t jumper[BoardLength];
+    };
+
+    /**
+     * A method to advance a SplitMix64 generator.
+     *
+     * @param s the state of the generator
+     * @return the next pseudo-random number
+     */
+    constexpr uint64_t splitMix64(uint64_t& s) {
+        uint64_t z = (s += 0x9E3779B97F4A7C15UL);
+        z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9UL;
+        z = (z ^ (z >> 27U)) * 0x94D049BB133111EBUL;
+        return z ^ (z >> 31U);
+    }
+
+    /**
+     * A method to generate the Zobrist keys at compile time.
+     *
+     * @return a fresh set of Zobrist keys
+     */
+    constexpr ZobristKeys makeZobristKeys() {
+        ZobristKeys z{};
+        uint64_t s = 0xBADC0FFEE0DDF00DUL;
+        for(auto& alliance: z.pieces)
+            for(auto& type: alliance)
+                for(uint64_t& k: type) k = splitMix64(s);
+        z.side = splitMix64(s);
+        for(uint64_t& k: z.jumper) k = splitMix64(s);
+        return z;
+    }
+
+    /** The Zobrist keys. */
+    constexpr ZobristKeys Zobrist = makeZobristKeys();
+
+    /** The material value of a pawn. */
+    constexpr int PawnValue = 100;
+
+    /** The material value of a king. */
+    constexpr int KingValue = 130;
+
+    /**
+     * <summary>
+     * Material and piece-square values for each alliance,
+     * piece type and square, signed from White's point of
+     * view, so that the board may keep their sum up to date
+     * in applyMove with a few additions.
+     * </summary>
+     *
+     * @struct PieceSquareTable
+     */
+    struct PieceSquareTable final {
+        int16_t values[2][2][BoardLength];
+    };
+
+    /**
+     * A method to build the piece-square table at compile
+     * time. Pawns gain value as they advance; kings gain value
+     * toward the center, where they reach the most squares.
+     * Black's values mirror White's through the center of the
+     * board, which maps playable squares onto playable squares.
+     *
+     * @return the piece-square table
+     */
+    constexpr PieceSquareTable makePieceSquareTable() {
+        constexpr int16_t Advance[] = { 0, 20, 14, 10, 7, 4, 2, 0 };
+        PieceSquareTable t{};
+        for(int sq = 0; sq < BoardLength; ++sq) {
+            const int r = sq >> 3, f = sq & 7,
+                      dr = r < 4? 3 - r: r - 4,
+                      df = f < 4? 3 - f: f - 4;
+            // White moves toward rank 1, which is rank index 0.
+            const auto pawn = (int16_t) (PawnValue + Advance[r]);
+            const auto king = (int16_t)
+                    (KingValue + 4 * (3 - (dr > df? dr: df)));
+            t.values[White][Pawn][sq] = pawn;
+            t.values[White][King][sq] = king;
+            t.values[Black][Pawn][BoardLength - 1 - sq] = (int16_t) -pawn;
+            t.values[Black][King][BoardLength - 1 - sq] = (int16_t) -king;
+        }
+        return t;
+    }
+
+    /** The piece-square table. */
+    constexpr PieceSquareTable PieceSquare = makePieceSquareTable();
+
+    /** The number of playable squares. */
+    constexpr int PlayableSquares = 32;
+
+    /** The playable squares, numbered 1-32 from the low bit. */
+    constexpr uint64_t PlayableMask = 0x55AA55AA55AA55AAL;
+
+    /**
+     * <summary>
+     * The binomial coefficients of up to the number of
+     * playable squares, so that a set of squares may be
+     * ranked among the sets of its size by adding a few
+     * entries.
+     * </summary>
+     *
+     * @struct BinomialTable
+     */
+    struct BinomialTable final {
+        uint32_t values[PlayableSquares + 1][PlayableSquares + 1];
+
+        /**
+         * A method to look up a binomial coefficient.
+         *
+         * @param n the size of the set
+         * @param k the size of the subsets
+         * @return the number of subsets of k elements of a
+         * set of n elements, or zero if k is out of range
+         */
+        [[nodiscard]]
+        constexpr uint32_t operator()(const int n, const int k) const
+        { return k < 0 || k > n? 0: values[n][k]; }
+    };
+
+    /**
+     * A method to build Pascal's triangle at compile time.
+     *
+     * @return the binomial table
+     */
+    constexpr BinomialTable makeBinomialTable() {
+        BinomialTable t{};
+        for(int n = 0; n <= PlayableSquares; ++n) {
+            t.values[n][0] = 1;
+            for(int k = 1; k <= n; ++k)
+                t.values[n][k] =
+                    t.values[n - 1][k - 1] + t.values[n - 1][k];
+        }
+        return t;
+    }
+
+    /** The binomial coefficients. */
+    constexpr BinomialTable Binomial = makeBinomialTable();
+
     /**
      * A method to "scan" the given unsigned long
      * from least significant bit to most significant